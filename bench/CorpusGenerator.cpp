@@ -0,0 +1,242 @@
+/*
+ * Generates a synthetic EScript binding project for benchmarks.
+ *
+ * Usage: CorpusGenerator <directory> [files] [types per file] [members per type]
+ *
+ * The project consists of a minimal EScript header (include/EScript/EScript.h),
+ * the binding files (src/Module<i>.cpp) and a DocConfig for WhatsUpDoc.
+ * Each file contains getClassName types, nested init functions, declareFunction &
+ * declareConstant calls as well as @defgroup, @ingroup and @name comment blocks.
+ */
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// -------------------------------------------------
+
+// existing directories are kept
+static void makeDir(const std::string& path) {
+#ifdef _WIN32
+  _mkdir(path.c_str());
+#else
+  mkdir(path.c_str(), 0755);
+#endif
+}
+
+static bool saveFile(const std::string& path, const std::string& content) {
+  std::ofstream out(path, std::ios::binary);
+  out << content;
+  return static_cast<bool>(out);
+}
+
+// -------------------------------------------------
+
+static const char* ESCRIPT_HEADER = R"(#ifndef ESCRIPT_H_
+#define ESCRIPT_H_
+// minimal subset of the EScript API used by the synthetic bindings
+namespace EScript {
+class Type;
+class Runtime;
+class ParameterValues;
+
+class Object {
+public:
+  virtual ~Object() {}
+  static Type* getTypeObject();
+};
+
+class Type : public Object {
+public:
+  explicit Type(Type* base = nullptr);
+};
+
+class Namespace : public Type {
+public:
+  Namespace();
+};
+
+template<class T> class _CountedRef {
+public:
+  _CountedRef(T* obj = nullptr) : obj(obj) {}
+  T* get() const { return obj; }
+  T* operator->() const { return obj; }
+private:
+  T* obj;
+};
+
+template<class T> class ERef : public _CountedRef<T> {
+public:
+  ERef(T* obj = nullptr) : _CountedRef<T>(obj) {}
+};
+
+typedef ERef<Object> ObjRef;
+
+class RtValue {
+public:
+  RtValue();
+  RtValue(int value);
+  RtValue(double value);
+  RtValue(bool value);
+  RtValue(const char* value);
+  RtValue(Object* value);
+};
+
+typedef RtValue (*_functionPtr)(Runtime& rt, const ObjRef& thisEObj, const ParameterValues& parameter);
+
+void declareFunction(Type* type, const char* name, _functionPtr fn);
+void declareFunction(Type* type, const char* name, int minParamCount, int maxParamCount, _functionPtr fn);
+void declareConstant(Type* type, const char* name, const RtValue& value);
+}
+#endif
+)";
+
+// -------------------------------------------------
+
+static std::string generateModule(int module, int types, int members) {
+  std::ostringstream out;
+  std::string ns = "Module" + std::to_string(module);
+  out << "#include <EScript/EScript.h>\n\n";
+  out << "namespace " << ns << " {\n";
+  out << "using namespace EScript;\n\n";
+
+  for(int t=0; t<types; ++t) {
+    std::string type = "Type" + std::to_string(t);
+    out << "class E_" << type << " : public Object {\n";
+    out << "public:\n";
+    out << "  static const char* getClassName() { return \"" << type << "\"; }\n";
+    out << "  static Type* getTypeObject() {\n";
+    out << "    static ERef<Type> typeObject = new Type(" << (t == 0 ? "Object" : "E_Type" + std::to_string(t-1)) << "::getTypeObject());\n";
+    out << "    return typeObject.get();\n";
+    out << "  }\n";
+    out << "  static void init(Namespace& lib);\n";
+    out << "};\n\n";
+
+    for(int m=0; m<members; ++m) {
+      out << "static RtValue " << type << "_fn" << m << "(Runtime&, const ObjRef&, const ParameterValues&) {\n";
+      out << "  return RtValue(" << m << ");\n";
+      out << "}\n\n";
+    }
+
+    out << "void E_" << type << "::init(Namespace& lib) {\n";
+    out << "  Type* typeObject = getTypeObject();\n";
+    out << "  //! Synthetic type " << type << " of " << ns << ".\n";
+    out << "  declareConstant(&lib, getClassName(), typeObject);\n\n";
+    out << "  //! @name Accessors\n";
+    out << "  //! @{\n";
+    for(int m=0; m<members; ++m) {
+      if(m == members / 2) {
+        out << "  //! @}\n\n";
+        out << "  //! @name Operations\n";
+        out << "  //! @{\n";
+      }
+      if(m % 3 == 2) {
+        out << "  /**\n";
+        out << "   * [ESMF] Number " << type << ".value" << m << "()\n";
+        out << "   * Returns the " << m << ". value of the object.\n";
+        out << "   * @code{.escript}\n";
+        out << "   * var v = obj.value" << m << "();\n";
+        out << "   * @endcode\n";
+        out << "   */\n";
+        out << "  declareFunction(typeObject, \"value" << m << "\", 0, " << (m % 4) << ", " << type << "_fn" << m << ");\n";
+      } else if(m % 3 == 1) {
+        out << "  //! [ESF] Number " << type << ".VALUE_" << m << "\n";
+        out << "  declareConstant(typeObject, \"VALUE_" << m << "\", RtValue(" << m << "));\n";
+      } else {
+        out << "  //! [ESMF] self " << type << ".method" << m << "(p0, [p1])\n";
+        if(m % 5 == 0)
+          out << "  //! @deprecated use value" << (m+2) << " instead\n";
+        out << "  declareFunction(typeObject, \"method" << m << "\", " << type << "_fn" << m << ");\n";
+      }
+    }
+    out << "  //! @}\n";
+    out << "}\n\n";
+  }
+
+  out << "namespace Detail {\n";
+  out << "void init(Namespace& lib) {\n";
+  out << "  //! @ingroup " << ns << "\n";
+  out << "  //! @{\n";
+  out << "  //! Version of the module.\n";
+  out << "  declareConstant(&lib, \"VERSION\", RtValue(" << module << "));\n";
+  out << "  //! @}\n";
+  out << "}\n";
+  out << "}\n\n";
+
+  out << "void init(Namespace& globals) {\n";
+  out << "  /**\n";
+  out << "   * @defgroup " << ns << " " << ns << "\n";
+  out << "   * Synthetic module number " << module << ".\n";
+  out << "   */\n";
+  out << "  //! [Namespace] " << ns << "\n";
+  out << "  Namespace* lib = new Namespace;\n";
+  out << "  declareConstant(&globals, \"" << ns << "\", lib);\n\n";
+  out << "  //! @ingroup " << ns << "\n";
+  out << "  //! @{\n";
+  for(int t=0; t<types; ++t)
+    out << "  E_Type" << t << "::init(*lib);\n";
+  out << "  //! @}\n\n";
+  out << "  Namespace* detail = new Namespace;\n";
+  out << "  declareConstant(lib, \"Detail\", detail);\n";
+  out << "  Detail::init(*detail);\n";
+  out << "}\n\n";
+  out << "}\n";
+  return out.str();
+}
+
+// -------------------------------------------------
+
+int main(int argc, char* argv[]) {
+  if(argc < 2) {
+    std::cout << "usage: CorpusGenerator <directory> [files=100] [types=8] [members=12]" << std::endl;
+    return 0;
+  }
+  std::string dir = argv[1];
+  int files = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+  int types = argc > 3 ? std::max(1, std::atoi(argv[3])) : 8;
+  int members = argc > 4 ? std::max(1, std::atoi(argv[4])) : 12;
+
+  makeDir(dir);
+  makeDir(dir + "/include");
+  makeDir(dir + "/include/EScript");
+  makeDir(dir + "/src");
+  makeDir(dir + "/json");
+  bool success = saveFile(dir + "/include/EScript/EScript.h", ESCRIPT_HEADER);
+
+  std::ostringstream lib;
+  lib << "#include <EScript/EScript.h>\n\n";
+  for(int i=0; i<files; ++i)
+    lib << "namespace Module" << i << " { void init(EScript::Namespace& globals); }\n";
+  lib << "\nvoid init(EScript::Namespace& globals) {\n";
+  for(int i=0; i<files; ++i)
+    lib << "  Module" << i << "::init(globals);\n";
+  lib << "}\n";
+  success &= saveFile(dir + "/src/Library.cpp", lib.str());
+
+  for(int i=0; i<files; ++i)
+    success &= saveFile(dir + "/src/Module" + std::to_string(i) + ".cpp", generateModule(i, types, members));
+
+  std::ostringstream config;
+  config << "# synthetic corpus: " << files << " files, " << types << " types per file, " << members << " members per type\n";
+  config << "PROJECT_FOLDER   = " << dir << "\n";
+  config << "INPUT            = src\n";
+  config << "INCLUDE          = include\n";
+  config << "FILE_PATTERNS    = *.cpp\n";
+  config << "OUTPUT_DIRECTORY = json\n";
+  success &= saveFile(dir + "/DocConfig", config.str());
+
+  if(!success) {
+    std::cerr << "could not write corpus to '" << dir << "'." << std::endl;
+    return 1;
+  }
+  std::cout << "Generated " << files << " binding files in " << dir << std::endl;
+  return 0;
+}
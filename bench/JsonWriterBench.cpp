@@ -0,0 +1,157 @@
+/*
+ * Compares the streaming JSON writer with the former stringstream based writer
+ * on a generated model.
+ *
+ * Usage: JsonWriterBench [compounds] [output directory]
+ * Without an output directory all documents are written to /dev/null.
+ */
+#include "ParsingContext.h"
+#include "JsonWriter.h"
+#include "JsonExport.h"
+
+#include <EScript/Utils/StringId.h>
+#include <EScript/Utils/StringUtils.h>
+#include <EScript/Utils/IO/IO.h>
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+
+using namespace WhatsUpDoc;
+using EScript::StringId;
+
+// -------------------------------------------------
+
+static void generateModel(ParsingContext& context, size_t count) {
+  const std::string text = "Returns the \"value\" of the object.\n| Parameter | Description |\n| --- | --- |\n| a | first\tvalue |";
+  for(size_t i=0; i<count; ++i) {
+    StringId id = toStringId("c:@N@Bench@S@Type" + std::to_string(i));
+    auto& cmp = context.compounds.at(id);
+    cmp.id = id;
+    cmp.name = "Type" + std::to_string(i);
+    cmp.fullname = "Bench." + cmp.name;
+    cmp.kind = i % 10 == 0 ? Compound::NAMESPACE : Compound::TYPE;
+    cmp.decription = text;
+    cmp.location = {"/usr/src/bench/Type" + std::to_string(i) + ".cpp", 42, 3};
+    if(i > 0)
+      cmp.base = toStringId("c:@N@Bench@S@Type" + std::to_string(i / 2));
+    for(size_t j=0; j<20; ++j) {
+      Member m;
+      m.name = "method" + std::to_string(j);
+      m.kind = j % 4 == 0 ? Member::CONST : Member::FUNCTION;
+      m.compound = id;
+      m.location = {cmp.location.file, static_cast<unsigned int>(100 + j), 5};
+      m.description = text;
+      m.cppRef = "Bench::Type" + std::to_string(i) + "::" + m.name;
+      m.minParams = 0;
+      m.maxParams = static_cast<int>(j % 3);
+      m.deprecated = j == 7;
+      context.members.emplace_back(std::move(m));
+      cmp.member.emplace_back(static_cast<MemberHandle>(context.members.size()-1));
+    }
+    for(size_t j=1; j<=4 && i*4+j < count; ++j) {
+      StringId ref = toStringId("c:@N@Bench@S@Type" + std::to_string(i*4+j));
+      context.references.emplace_back(Reference{"Type" + std::to_string(i*4+j), id, cmp.location, ref});
+      cmp.children.emplace_back(static_cast<ReferenceHandle>(context.references.size()-1));
+    }
+  }
+}
+
+// -------------------------------------------------
+
+// the writer used before, kept for comparison
+static void writeLegacy(const Compound& cmp, const ParsingContext* context, const std::string& path) {
+  using namespace EScript::StringUtils;
+  std::string kind = getKindName(cmp);
+  auto& parent = findCompound(cmp.parentId, context);
+  auto& group = findCompound(cmp.group, context);
+  auto& base = findCompound(cmp.base, context);
+
+  std::stringstream json;
+  json << "{" << std::endl;
+  json << "  \"id\" : \"" << cmp.id << "\"," << std::endl;
+  json << "  \"name\" : \"" << cmp.name << "\"," << std::endl;
+  json << "  \"fullname\" : \"" << cmp.fullname << "\"," << std::endl;
+  json << "  \"kind\" : \"" << kind << "\"," << std::endl;
+  json << "  \"location\" : \"" << cmp.location << "\"," << std::endl;
+  json << "  \"parent\" : \"" << (parent.name.empty() ? "" : toString(cmp.parentId)) << "\"," << std::endl;
+  json << "  \"group\" : \"" << (group.name.empty() ? "" : toString(cmp.group)) << "\"," << std::endl;
+  json << "  \"base\" : \"" << (base.name.empty() ? "" : toString(cmp.base)) << "\"," << std::endl;
+  json << "  \"description\" : \"" << escape(cmp.decription) << "\"," << std::endl;
+  json << "  \"children\" : [" << std::endl;
+  for(auto h : cmp.children) {
+    auto& v = context->references[h];
+    std::string fullname = findCompound(v.compound, context).fullname + "." + v.name;
+    json << "    {" << std::endl;
+    json << "      \"name\" : \"" << v.name << "\"," << std::endl;
+    json << "      \"fullname\" : \"" << fullname << "\"," << std::endl;
+    json << "      \"ref\" : \"" << v.ref << "\"," << std::endl;
+    json << "      \"location\" : \"" << v.location << "\"," << std::endl;
+    json << "    }," << std::endl;
+  }
+  json << "  ]," << std::endl;
+  json << "  \"member\" : [" << std::endl;
+  for(auto h : cmp.member) {
+    auto& v = context->members[h];
+    std::string kind = v.kind == Member::CONST ? "const" : v.kind == Member::FUNCTION ? "function" : "unknown";
+    std::string fullname = findCompound(v.compound, context).fullname + "." + v.name;
+    json << "    {" << std::endl;
+    json << "      \"name\" : \"" << v.name << "\"," << std::endl;
+    json << "      \"fullname\" : \"" << fullname << "\"," << std::endl;
+    json << "      \"kind\" : \"" << kind << "\"," << std::endl;
+    json << "      \"minParams\" : " << v.minParams << "," <<std::endl;
+    json << "      \"maxParams\" : " << v.maxParams << "," << std::endl;
+    json << "      \"location\" : \"" << v.location << "\"," << std::endl;
+    json << "      \"description\" : \"" << escape(v.description) << "\"," << std::endl;
+    json << "      \"cpp\" : \"" << v.cppRef << "\"," << std::endl;
+    json << "      \"group\" : \"" << v.group << "\"," << std::endl;
+    json << "      \"deprecated\" : " << (v.deprecated ? "true" : "false") << "," << std::endl;
+    json << "    }," << std::endl;
+  }
+  json << "  ]," << std::endl;
+  json << "}" << std::endl;
+  EScript::IO::saveFile(path, json.str());
+}
+
+// -------------------------------------------------
+
+int main(int argc, char* argv[]) {
+  size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  std::string dir = argc > 2 ? argv[2] : "";
+  auto getPath = [&](const char* prefix, size_t i) {
+    return dir.empty() ? std::string("/dev/null") : dir + "/" + prefix + std::to_string(i) + ".json";
+  };
+
+  ParsingContext context;
+  generateModel(context, count);
+  std::cout << "model: " << count << " compounds, " << context.members.size() << " members, "
+            << context.references.size() << " references" << std::endl;
+
+  typedef std::chrono::steady_clock Clock;
+  auto start = Clock::now();
+  for(CompoundStore::Index i=0; i<context.compounds.size(); ++i)
+    writeLegacy(context.compounds[i], &context, getPath("legacy_", i));
+  double legacy = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  start = Clock::now();
+  JsonWriter writer;
+  size_t failed = 0;
+  for(CompoundStore::Index i=0; i<context.compounds.size(); ++i) {
+    if(!writer.open(getPath("stream_", i))) {
+      ++failed;
+      continue;
+    }
+    writeCompoundJSON(writer, context.compounds[i], &context);
+    if(!writer.close())
+      ++failed;
+  }
+  double streaming = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  std::cout << "legacy writer:    " << legacy << " ms" << std::endl;
+  std::cout << "streaming writer: " << streaming << " ms (" << legacy / streaming << "x)" << std::endl;
+  if(failed > 0)
+    std::cerr << failed << " documents could not be written." << std::endl;
+  return failed > 0 ? 1 : 0;
+}
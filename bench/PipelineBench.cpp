@@ -0,0 +1,116 @@
+/*
+ * Runs the phases of the documentation pipeline on a project (e.g. one created
+ * by CorpusGenerator) and reports the throughput of each phase.
+ *
+ * Usage: PipelineBench <project folder> [threads=1] [json|bundle]
+ * The project is expected to contain the folders src & include, the output
+ * is written to <project folder>/json.
+ */
+#include "Parser.h"
+#include "FileDiscovery.h"
+#include "FileFilter.h"
+#include "Statistics.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace WhatsUpDoc;
+
+// -------------------------------------------------
+
+// peak resident set size in MiB (0 if unsupported)
+static double getPeakRSS() {
+#ifndef _WIN32
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+#else
+  return 0;
+#endif
+}
+
+static void report(const std::string& phase, const Stopwatch& watch, size_t files, size_t members) {
+  double time = watch.getWallTime();
+  double rate = time > 0 ? 1.0 / time : 0;
+  std::cout << std::left << std::setw(10) << phase << std::right << std::fixed << std::setprecision(3)
+            << std::setw(10) << time << "s" << std::setw(10) << watch.getCpuTime() << "s cpu"
+            << std::setprecision(1) << std::setw(12) << files * rate << " files/s";
+  if(members > 0)
+    std::cout << std::setw(14) << members * rate << " members/s";
+  std::cout << std::setw(10) << getPeakRSS() << " MiB peak" << std::endl;
+}
+
+// -------------------------------------------------
+
+int main(int argc, char* argv[]) {
+  if(argc < 2) {
+    std::cout << "usage: PipelineBench <project folder> [threads=1] [json|bundle]" << std::endl;
+    return 0;
+  }
+  std::string project = argv[1];
+  unsigned int threads = argc > 2 ? static_cast<unsigned int>(std::max(1, std::atoi(argv[2]))) : 1;
+  bool bundle = argc > 3 && std::string(argv[3]) == "bundle";
+
+  Parser parser;
+  parser.enableStatistics();
+  parser.addInclude(project);
+  parser.addInclude(project + "/include");
+
+  // discovery
+  Stopwatch watch;
+  DiscoveryOptions discovery;
+  discovery.patterns = {"*.cpp"};
+  discovery.threads = threads;
+  std::vector<std::string> files = findFiles({project + "/src"}, discovery);
+  report("discovery", watch, files.size(), 0);
+  if(files.empty()) {
+    std::cerr << "no source files found in '" << project << "/src'." << std::endl;
+    return 1;
+  }
+  parser.setScope({project}, {});
+
+  // filter
+  watch.reset();
+  files.erase(std::remove_if(files.begin(), files.end(), [](const std::string& f) { return !mayContainBindings(f); }), files.end());
+  report("filter", watch, files.size(), 0);
+
+  // parse, visit & resolve
+  watch.reset();
+  parser.parseFiles(files, threads);
+  size_t members = 0;
+  for(auto& f : parser.getStatistics()->getFiles())
+    members += f.functions + f.constants;
+  report("parse", watch, files.size(), members);
+
+  // write
+  watch.reset();
+  if(bundle)
+    parser.writeBundle(project + "/json/whatsupdoc.bundle");
+  else
+    parser.writeJSON(project + "/json");
+  report("write", watch, files.size(), members);
+
+  auto stats = parser.getStatistics();
+  double parse = 0, visit = 0;
+  for(auto& f : stats->getFiles()) {
+    parse += f.parse;
+    visit += f.visit;
+  }
+  std::cout << std::endl << files.size() << " files, " << members << " members (" << threads << " threads)" << std::endl;
+  std::cout << std::fixed << std::setprecision(3) << "  libclang " << parse << "s, visitors " << visit
+            << "s (summed over all threads), resolve " << stats->getWallTime(Statistics::RESOLVE) << "s" << std::endl;
+  return 0;
+}
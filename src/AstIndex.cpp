@@ -0,0 +1,239 @@
+#include "AstIndex.h"
+#include "Helper.h"
+
+#include <algorithm>
+
+namespace WhatsUpDoc {
+  
+static const uint32_t NO_NODE = UINT32_MAX;
+
+// -------------------------------------------------
+
+CXChildVisitResult flattenVisitor(CXCursor cursor, CXCursor parent, CXClientData data) {
+  auto index = reinterpret_cast<AstIndex*>(data);
+  // a subtree indexed before its ancestor is copied instead of walked again
+  uint32_t existing = index->findIndex(cursor);
+  if(existing != NO_NODE)
+    index->moveSubtree(existing);
+  else
+    index->add(cursor);
+  return CXChildVisit_Continue;
+}
+
+uint32_t AstIndex::add(CXCursor cursor) {
+  uint32_t index = static_cast<uint32_t>(nodes.size());
+  nodes.emplace_back();
+  nodes.back().cursor = cursor;
+  nodes.back().kind = clang_getCursorKind(cursor);
+  lookup.emplace(clang_hashCursor(cursor), index);
+  clang_visitChildren(cursor, *flattenVisitor, this);
+  nodes[index].end = static_cast<uint32_t>(nodes.size());
+  return index;
+}
+
+void AstIndex::moveSubtree(uint32_t first) {
+  uint32_t last = nodes[first].end;
+  uint32_t offset = static_cast<uint32_t>(nodes.size()) - first;
+  nodes.reserve(nodes.size() + (last - first));
+  // the old range stays valid until it is dropped by compact()
+  for(uint32_t i = first; i < last; ++i) {
+    nodes.push_back(nodes[i]);
+    nodes.back().end += offset;
+  }
+  moved.emplace_back(first, last);
+}
+
+// drops the moved ranges & renumbers the following nodes, returns the new index of the given node (or NO_NODE)
+uint32_t AstIndex::compact(uint32_t index) {
+  std::sort(moved.begin(), moved.end());
+  moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+  uint32_t target = moved.front().first;
+  uint32_t shift = 0;
+  size_t next = 0;
+  for(uint32_t i = target; i < nodes.size(); ++i) {
+    if(next < moved.size() && i == moved[next].first) {
+      shift += moved[next].second - moved[next].first;
+      i = moved[next++].second - 1;
+      continue;
+    }
+    if(i == index)
+      index = target;
+    nodes[i].end -= shift;
+    nodes[target++] = std::move(nodes[i]);
+  }
+  nodes.resize(target);
+  moved.clear();
+  lookup.clear();
+  for(uint32_t i = 0; i < nodes.size(); ++i)
+    lookup.emplace(clang_hashCursor(nodes[i].cursor), i);
+  return index;
+}
+
+// -------------------------------------------------
+
+uint32_t AstIndex::findIndex(CXCursor cursor) const {
+  auto range = lookup.equal_range(clang_hashCursor(cursor));
+  for(auto it = range.first; it != range.second; ++it) {
+    if(clang_equalCursors(nodes[it->second].cursor, cursor))
+      return it->second;
+  }
+  return NO_NODE;
+}
+
+uint32_t AstIndex::getIndex(CXCursor cursor) {
+  uint32_t index = findIndex(cursor);
+  if(index != NO_NODE)
+    return index;
+  index = add(cursor);
+  return moved.empty() || guards > 0 ? index : compact(index);
+}
+
+AstIndex::Guard::~Guard() {
+  if(--ast.guards == 0 && !ast.moved.empty())
+    ast.compact(NO_NODE);
+}
+
+// -------------------------------------------------
+
+const std::string& AstIndex::getSpelling(uint32_t index) {
+  auto& node = nodes[index];
+  if(!node.hasSpelling) {
+    node.spelling = toString(clang_getCursorSpelling(node.cursor));
+    node.hasSpelling = true;
+  }
+  return node.spelling;
+}
+
+AstIndex::TypeClass AstIndex::getTypeClass(uint32_t index) {
+  if(nodes[index].typeClass == ANY_TYPE)
+    nodes[index].typeClass = classifyType(clang_getCursorType(nodes[index].cursor));
+  return nodes[index].typeClass;
+}
+
+// -------------------------------------------------
+
+AstIndex::TypeClass AstIndex::classifyType(CXType type) {
+  // strip pointers, references & function types
+  for(bool done = false; !done;) {
+    type = clang_getCanonicalType(type);
+    switch(type.kind) {
+      case CXType_Pointer:
+      case CXType_LValueReference:
+      case CXType_RValueReference:
+        type = clang_getPointeeType(type);
+        break;
+      case CXType_FunctionProto:
+      case CXType_FunctionNoProto:
+        type = clang_getResultType(type);
+        break;
+      default:
+        done = true;
+        break;
+    }
+  }
+  CXCursor decl = clang_getTypeDeclaration(type);
+  if(clang_Cursor_isNull(decl) || clang_getCursorKind(decl) == CXCursor_NoDeclFound)
+    return OTHER;
+  decl = clang_getCanonicalCursor(decl);
+  unsigned hash = clang_hashCursor(decl);
+  auto range = typeClasses.equal_range(hash);
+  for(auto it = range.first; it != range.second; ++it) {
+    if(clang_equalCursors(it->second.first, decl))
+      return it->second.second;
+  }
+  
+  TypeClass result = OTHER;
+  std::string name = getFullyQualifiedName(decl);
+  if(name == "EScript::Namespace") {
+    result = NAMESPACE;
+  } else if(name == "EScript::Type") {
+    result = TYPE;
+  } else if(name == "EScript::RtValue") {
+    result = RT_VALUE;
+  } else if((name == "EScript::ERef" || name == "EScript::_CountedRef") && clang_Type_getNumTemplateArguments(type) > 0) {
+    // reference wrappers
+    result = classifyType(clang_Type_getTemplateArgumentAsType(type, 0));
+  }
+  typeClasses.emplace(hash, std::make_pair(decl, result));
+  return result;
+}
+
+// -------------------------------------------------
+
+uint32_t AstIndex::find(uint32_t first, uint32_t last, const std::string& name, int kind, TypeClass type) {
+  for(uint32_t i = first; i < last; ++i) {
+    if(
+      (kind == 0 || nodes[i].kind == kind) &&
+      (name.empty() || getSpelling(i) == name) &&
+      (type == ANY_TYPE || getTypeClass(i) == type)
+    ) 
+      return i;
+  }
+  return NO_NODE;
+}
+
+CXCursor AstIndex::findCursor(CXCursor cursor, const std::string& name, int kind, TypeClass type, bool includeSelf) {
+  uint32_t index = getIndex(cursor);
+  uint32_t result = find(includeSelf ? index : index+1, nodes[index].end, name, kind, type);
+  return result == NO_NODE ? clang_getNullCursor() : nodes[result].cursor;
+}
+
+// -------------------------------------------------
+
+CXCursor AstIndex::findRef(CXCursor cursor, const std::string& name) {
+  CXCursor call = findCursor(cursor, name, CXCursor_MemberRefExpr);
+  if(clang_Cursor_isNull(call))
+    call = findCursor(cursor, name, CXCursor_DeclRefExpr);
+  if(!clang_Cursor_isNull(call))
+    return clang_getCursorReferenced(call);
+  return call;
+}
+
+// -------------------------------------------------
+
+CXCursor AstIndex::findTypeRef(CXCursor cursor, TypeClass type) {
+  CXCursor typeCursor = findCursor(cursor, "", CXCursor_MemberRefExpr, type);
+  if(clang_Cursor_isNull(typeCursor))
+    typeCursor = findCursor(cursor, "", CXCursor_DeclRefExpr, type);
+  if(!clang_Cursor_isNull(typeCursor))
+    return clang_getCursorReferenced(typeCursor);
+  return typeCursor;
+}
+
+// -------------------------------------------------
+
+CXCursor AstIndex::findExposed(CXCursor cursor) {
+  uint32_t index = getIndex(cursor);
+  for(uint32_t i = index; i < nodes[index].end; ++i) {
+    switch(nodes[i].kind) {
+      case CXCursor_UnexposedAttr:
+      case CXCursor_UnexposedDecl:
+      case CXCursor_UnexposedExpr:
+      case CXCursor_UnexposedStmt:
+      case CXCursor_UnaryOperator: // also skip * &
+        continue;
+      default: break;
+    }
+    // also skip RtValue
+    if(getTypeClass(i) == RT_VALUE)
+      continue;
+    return nodes[i].cursor;
+  }
+  return clang_getNullCursor();
+}
+
+// -------------------------------------------------
+
+CXCursor AstIndex::getCursorRef(CXCursor cursor) {
+  if(clang_getCursorKind(cursor) == CXCursor_DeclRefExpr)
+    return clang_getCursorReferenced(cursor);
+  uint32_t index = getIndex(cursor);
+  uint32_t ref = find(index+1, nodes[index].end, "", CXCursor_DeclRefExpr, ANY_TYPE);
+  if(ref != NO_NODE)
+    return clang_getCursorReferenced(nodes[ref].cursor);
+  return clang_getNullCursor();
+}
+
+// -------------------------------------------------
+
+} /* WhatsUpDoc */
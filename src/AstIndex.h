@@ -0,0 +1,90 @@
+#ifndef WHATSUPDOC_ASTINDEX_H_
+#define WHATSUPDOC_ASTINDEX_H_
+
+#include <clang-c/Index.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+
+/**
+ * Flattened cursor subtrees of a translation unit. 
+ * A subtree is walked once when one of its cursors is first queried, the nodes are
+ * stored in visiting order so that each subtree is a contiguous range of nodes. 
+ * The spellings & type classes of the nodes are computed at most once. If an ancestor
+ * of an indexed subtree is queried later, the subtree is copied into the new one and
+ * the old range is dropped, which renumbers the following nodes unless a Guard exists.
+ */
+class AstIndex {
+public:
+  // EScript classes a cursor type (or the pointee, reference or function result) can refer to
+  enum TypeClass : uint8_t {
+    ANY_TYPE, // no type filter in the find* functions
+    OTHER, 
+    NAMESPACE, 
+    TYPE, 
+    RT_VALUE,
+  };
+  
+  struct Node {
+    CXCursor cursor;
+    CXCursorKind kind;
+    // end of the subtree (exclusive)
+    uint32_t end;
+    bool hasSpelling = false;
+    TypeClass typeClass = ANY_TYPE;
+    std::string spelling;
+  };
+  
+  // keeps the node indices valid while it exists, e.g., while a subtree is iterated
+  class Guard {
+  public:
+    explicit Guard(AstIndex& ast) : ast(ast) { ++ast.guards; }
+    ~Guard();
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+  private:
+    AstIndex& ast;
+  };
+
+  // node index of the cursor, the subtree of the cursor is [index, getNode(index).end)
+  uint32_t getIndex(CXCursor cursor);
+  const Node& getNode(uint32_t index) const { return nodes[index]; }
+  const std::string& getSpelling(uint32_t index);
+  TypeClass getTypeClass(uint32_t index);
+  TypeClass getTypeClass(CXCursor cursor) { return classifyType(clang_getCursorType(cursor)); }
+  
+  CXCursor findCursor(CXCursor cursor, const std::string& name="", int kind=0, TypeClass type=ANY_TYPE, bool includeSelf=true);
+  // referenced cursor of the first MemberRefExpr or DeclRefExpr with the given name
+  CXCursor findRef(CXCursor cursor, const std::string& name);
+  CXCursor findTypeRef(CXCursor cursor, TypeClass type);
+  // skips unexposed cursors, unary operators & EScript::RtValue
+  CXCursor findExposed(CXCursor cursor);
+  // referenced cursor of the cursor itself or of the first DeclRefExpr
+  CXCursor getCursorRef(CXCursor cursor);
+private:
+  friend CXChildVisitResult flattenVisitor(CXCursor cursor, CXCursor parent, CXClientData data);
+  uint32_t add(CXCursor cursor);
+  uint32_t findIndex(CXCursor cursor) const;
+  void moveSubtree(uint32_t first);
+  uint32_t compact(uint32_t index);
+  uint32_t find(uint32_t first, uint32_t last, const std::string& name, int kind, TypeClass type);
+  TypeClass classifyType(CXType type);
+  
+  std::vector<Node> nodes;
+  // clang_hashCursor -> node index
+  std::unordered_multimap<unsigned, uint32_t> lookup;
+  // ranges of subtrees moved while flattening an ancestor
+  std::vector<std::pair<uint32_t, uint32_t>> moved;
+  // the moved ranges are dropped when the last guard is released
+  uint32_t guards = 0;
+  // clang_hashCursor of the canonical type declaration -> declaration & class
+  std::unordered_multimap<unsigned, std::pair<CXCursor, TypeClass>> typeClasses;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_ASTINDEX_H_ */
@@ -0,0 +1,260 @@
+#include "Bundle.h"
+#include "JsonWriter.h"
+#include "JsonExport.h"
+#include "ParsingContext.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+namespace WhatsUpDoc {
+
+static const char BUNDLE_MAGIC[8] = {'W', 'U', 'D', 'B', 'U', 'N', 'D', 'L'};
+static const uint64_t HEADER_SIZE = 32;
+static const uint64_t ENTRY_SIZE = 40;
+static const uint64_t NAME_SIZE = 4;
+
+// -------------------------------------------------
+
+// 64 bit offsets, long has only 32 bits on Windows & 32 bit platforms
+static bool seekFile(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+  return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+  return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+static void putUInt(std::string& out, uint64_t value, int bytes) {
+  for(int i=0; i<bytes; ++i)
+    out.push_back(static_cast<char>((value >> (8*i)) & 0xff));
+}
+
+static uint64_t getUInt(const char* data, int bytes) {
+  uint64_t value = 0;
+  for(int i=0; i<bytes; ++i)
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8*i);
+  return value;
+}
+
+// -------------------------------------------------
+
+bool writeBundle(const std::string& path, const ParsingContext* context) {
+  auto& compounds = context->compounds;
+  std::vector<CompoundStore::Index> entries;
+  for(CompoundStore::Index i=0; i<compounds.size(); ++i) {
+    auto& cmp = compounds[i];
+    if(!cmp.isRef() && !cmp.name.empty())
+      entries.emplace_back(i);
+  }
+  std::sort(entries.begin(), entries.end(), [&](CompoundStore::Index a, CompoundStore::Index b) {
+    return toString(compounds[a].id) < toString(compounds[b].id);
+  });
+  std::vector<uint32_t> names(entries.size());
+  for(uint32_t i=0; i<names.size(); ++i)
+    names[i] = i;
+  std::stable_sort(names.begin(), names.end(), [&](uint32_t a, uint32_t b) {
+    return compounds[entries[a]].fullname < compounds[entries[b]].fullname;
+  });
+
+  std::string strings;
+  std::vector<uint64_t> stringOffsets;
+  for(auto index : entries) {
+    auto& cmp = compounds[index];
+    stringOffsets.emplace_back(strings.size());
+    strings.append(toString(cmp.id));
+    strings.append(cmp.fullname);
+  }
+  uint64_t stringsOffset = HEADER_SIZE + entries.size() * (ENTRY_SIZE + NAME_SIZE);
+  uint64_t recordsOffset = stringsOffset + strings.size();
+
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if(!file)
+    return false;
+  bool success = seekFile(file, recordsOffset);
+
+  // records
+  std::vector<uint64_t> recordSizes;
+  recordSizes.reserve(entries.size());
+  JsonWriter writer;
+  for(auto index : entries) {
+    writer.open(file);
+    writeCompoundJSON(writer, compounds[index], context);
+    success &= writer.close();
+    recordSizes.emplace_back(writer.getSize());
+  }
+
+  // header & index
+  std::string index;
+  index.reserve(recordsOffset);
+  index.append(BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+  putUInt(index, BUNDLE_VERSION, 4);
+  putUInt(index, entries.size(), 4);
+  putUInt(index, stringsOffset, 8);
+  putUInt(index, recordsOffset, 8);
+  uint64_t recordOffset = recordsOffset;
+  for(size_t i=0; i<entries.size(); ++i) {
+    auto& cmp = compounds[entries[i]];
+    auto& id = toString(cmp.id);
+    putUInt(index, stringOffsets[i], 8);
+    putUInt(index, id.size(), 4);
+    putUInt(index, cmp.fullname.size(), 4);
+    putUInt(index, stringOffsets[i] + id.size(), 8);
+    putUInt(index, recordOffset, 8);
+    putUInt(index, recordSizes[i], 8);
+    recordOffset += recordSizes[i];
+  }
+  for(auto v : names)
+    putUInt(index, v, 4);
+  index.append(strings);
+
+  success &= seekFile(file, 0);
+  success &= std::fwrite(index.data(), 1, index.size(), file) == index.size();
+  success &= std::fclose(file) == 0;
+  return success;
+}
+
+// -------------------------------------------------
+
+BundleReader::~BundleReader() {
+  close();
+}
+
+bool BundleReader::open(const std::string& path) {
+  close();
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+  struct stat st;
+  if(fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(HEADER_SIZE)) {
+    ::close(fd);
+    return false;
+  }
+  void* mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if(mem == MAP_FAILED)
+    return false;
+  madvise(mem, st.st_size, MADV_RANDOM);
+  data = reinterpret_cast<const char*>(mem);
+  length = st.st_size;
+  mapped = true;
+#else
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if(!in || static_cast<uint64_t>(in.tellg()) < HEADER_SIZE)
+    return false;
+  length = static_cast<size_t>(in.tellg());
+  char* buffer = new char[length];
+  in.seekg(0);
+  in.read(buffer, length);
+  data = buffer;
+  if(!in) {
+    close();
+    return false;
+  }
+#endif
+  count = static_cast<uint32_t>(getUInt(data + 12, 4));
+  strings = getUInt(data + 16, 8);
+  uint64_t records = getUInt(data + 24, 8);
+  bool valid = std::memcmp(data, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) == 0 && getUInt(data + 8, 4) == BUNDLE_VERSION;
+  valid = valid && HEADER_SIZE + count * (ENTRY_SIZE + NAME_SIZE) <= strings && strings <= records && records <= length;
+  if(!valid)
+    close();
+  return valid;
+}
+
+void BundleReader::close() {
+  if(data) {
+#ifndef _WIN32
+    if(mapped)
+      munmap(const_cast<char*>(data), length);
+#else
+    delete[] data;
+#endif
+  }
+  data = nullptr;
+  length = 0;
+  mapped = false;
+  count = 0;
+  strings = 0;
+}
+
+// -------------------------------------------------
+
+std::string BundleReader::getId(uint32_t entry) const {
+  if(entry >= count)
+    return "";
+  const char* e = data + HEADER_SIZE + entry * ENTRY_SIZE;
+  uint64_t offset = strings + getUInt(e, 8);
+  uint64_t size = getUInt(e + 8, 4);
+  if(offset + size > length)
+    return "";
+  return std::string(data + offset, size);
+}
+
+std::string BundleReader::getFullname(uint32_t entry) const {
+  if(entry >= count)
+    return "";
+  const char* e = data + HEADER_SIZE + entry * ENTRY_SIZE;
+  uint64_t offset = strings + getUInt(e + 16, 8);
+  uint64_t size = getUInt(e + 12, 4);
+  if(offset + size > length)
+    return "";
+  return std::string(data + offset, size);
+}
+
+BundleReader::Record BundleReader::getRecord(uint32_t entry) const {
+  Record record;
+  if(entry >= count)
+    return record;
+  const char* e = data + HEADER_SIZE + entry * ENTRY_SIZE;
+  uint64_t offset = getUInt(e + 24, 8);
+  uint64_t size = getUInt(e + 32, 8);
+  if(offset > length || size > length - offset)
+    return record;
+  record.data = data + offset;
+  record.length = static_cast<size_t>(size);
+  return record;
+}
+
+// -------------------------------------------------
+
+BundleReader::Record BundleReader::findById(const std::string& id) const {
+  uint32_t first = 0, last = count;
+  while(first < last) {
+    uint32_t mid = first + (last - first) / 2;
+    if(getId(mid) < id)
+      first = mid + 1;
+    else
+      last = mid;
+  }
+  return first < count && getId(first) == id ? getRecord(first) : Record();
+}
+
+BundleReader::Record BundleReader::findByFullname(const std::string& fullname) const {
+  const char* names = data + HEADER_SIZE + count * ENTRY_SIZE;
+  uint32_t first = 0, last = count;
+  while(first < last) {
+    uint32_t mid = first + (last - first) / 2;
+    if(getFullname(static_cast<uint32_t>(getUInt(names + mid * NAME_SIZE, 4))) < fullname)
+      first = mid + 1;
+    else
+      last = mid;
+  }
+  if(first == count)
+    return Record();
+  uint32_t entry = static_cast<uint32_t>(getUInt(names + first * NAME_SIZE, 4));
+  return getFullname(entry) == fullname ? getRecord(entry) : Record();
+}
+
+} /* WhatsUpDoc */
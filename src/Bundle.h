@@ -0,0 +1,66 @@
+#ifndef WHATSUPDOC_BUNDLE_H_
+#define WHATSUPDOC_BUNDLE_H_
+
+#include <string>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+struct ParsingContext;
+
+/**
+ * Single file containing the documents of all compounds.
+ *
+ * Layout (integers are little endian):
+ *   header   magic "WUDBUNDL", uint32 version, uint32 entry count,
+ *            uint64 offset of the string table, uint64 offset of the records
+ *   entries  per compound sorted by id: uint64 id offset, uint32 id length,
+ *            uint32 fullname length, uint64 fullname offset, uint64 record offset,
+ *            uint64 record length (string offsets are relative to the string table)
+ *   names    uint32 entry indices sorted by fullname
+ *   strings  ids & full names
+ *   records  the JSON documents of the compounds
+ */
+static const uint32_t BUNDLE_VERSION = 1;
+
+// writes all named compounds, the full names have to be computed before
+bool writeBundle(const std::string& path, const ParsingContext* context);
+
+/**
+ * Read-only access to a bundle. The file is mapped into memory (if supported),
+ * only the index and the requested records are touched.
+ */
+class BundleReader {
+public:
+  struct Record {
+    const char* data = nullptr;
+    size_t length = 0;
+    bool isNull() const { return data == nullptr; }
+  };
+
+  BundleReader() = default;
+  ~BundleReader();
+  BundleReader(const BundleReader&) = delete;
+  BundleReader& operator=(const BundleReader&) = delete;
+
+  // returns false if the file is no valid bundle
+  bool open(const std::string& path);
+  void close();
+
+  uint32_t size() const { return count; }
+  std::string getId(uint32_t entry) const;
+  std::string getFullname(uint32_t entry) const;
+  Record getRecord(uint32_t entry) const;
+
+  Record findById(const std::string& id) const;
+  Record findByFullname(const std::string& fullname) const;
+private:
+  const char* data = nullptr;
+  size_t length = 0;
+  bool mapped = false;
+  uint32_t count = 0;
+  uint64_t strings = 0;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_BUNDLE_H_ */
@@ -1,82 +1,288 @@
 #include "CommentParser.h"
 
 #include <EScript/Utils/StringUtils.h>
-#include <regex>
+
+#include <cstring>
 
 namespace WhatsUpDoc {
-using namespace CommentTokens;
 using namespace EScript::StringUtils;
 
 // -------------------------------------------------
 
-std::string escapeMarkdown(const std::string& str) {
-  return replaceMultiple(str, {
-    {"|","\\|"},
-    {"*","\\*"},
-  });
+void CommentBuffer::appendEscaped(const CommentToken& token, std::string& out) const {
+  const char* str = text.data() + token.offset;
+  for(uint32_t i = 0; i < token.length; ++i) {
+    if(str[i] == '|' || str[i] == '*')
+      out += '\\';
+    out += str[i];
+  }
 }
 
 // -------------------------------------------------
+// character classes (as used by the former ECMAScript regular expressions)
 
-std::deque<CommentTokenPtr> parseComment(const std::string& comment, const Location& location) {
-  std::deque<CommentTokenPtr> result;
-  
-  // TODO: parse doxygen commands
-  std::stringstream regex;
-  regex << R"((?:(?:/\*(?:!|\*+))|(?://(?:!|/+))|(?:\s*\*+/?)|(?:\s{)" << location.col << R"(}))\s?(.*))";    
-  std::regex lineRegex = std::regex(regex.str());
+static inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static inline bool isWord(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// '.' does not match line terminators
+static inline bool isAny(char c) {
+  return c != '\n' && c != '\r';
+}
+
+static inline size_t skipSpace(const char* s, size_t n, size_t i) {
+  while(i < n && isSpace(s[i]))
+    ++i;
+  return i;
+}
+
+static inline size_t skipWord(const char* s, size_t n, size_t i) {
+  while(i < n && isWord(s[i]))
+    ++i;
+  return i;
+}
+
+static inline size_t skipAny(const char* s, size_t n, size_t i) {
+  while(i < n && isAny(s[i]))
+    ++i;
+  return i;
+}
+
+static inline bool isRestAny(const char* s, size_t n, size_t i) {
+  return skipAny(s, n, i) == n;
+}
+
+static inline bool isBlank(const char* s, size_t n) {
+  return trim(std::string(s, n)).empty();
+}
+
+// matches '@command' or '\command' at position i, returns the position after the command or npos
+static inline size_t matchCommand(const char* s, size_t n, size_t i, const char* command) {
+  size_t length = std::strlen(command);
+  if(i < n && (s[i] == '@' || s[i] == '\\') && n - i - 1 >= length && std::memcmp(s + i + 1, command, length) == 0)
+    return i + 1 + length;
+  return std::string::npos;
+}
+
+// -------------------------------------------------
+
+// ranges of the buffer text which form a token text
+class Pieces {
+public:
+  void add(size_t begin, size_t end) {
+    if(end == begin)
+      return;
+    if(!ranges.empty() && ranges.back().second == begin)
+      ranges.back().second = end;
+    else
+      ranges.emplace_back(begin, end);
+  }
+  // returns offset & length of the joined ranges, non-contiguous pieces are copied to the end of the text
+  std::pair<uint32_t, uint32_t> store(std::string& text) const {
+    if(ranges.empty())
+      return {static_cast<uint32_t>(text.size()), 0};
+    if(ranges.size() == 1)
+      return {static_cast<uint32_t>(ranges.front().first), static_cast<uint32_t>(ranges.front().second - ranges.front().first)};
+    std::string joined;
+    for(auto& r : ranges)
+      joined.append(text, r.first, r.second - r.first);
+    uint32_t offset = static_cast<uint32_t>(text.size());
+    text += joined;
+    return {offset, static_cast<uint32_t>(joined.size())};
+  }
+private:
+  std::vector<std::pair<size_t, size_t>> ranges;
+};
+
+// -------------------------------------------------
+
+// length of a comment line prefix ('/**', '///', ' * ', indentation) starting at i or npos
+static size_t matchLinePrefix(const char* s, size_t n, size_t i, unsigned int col) {
+  // '/*!', '/**...', '//!', '///...'
+  if(i+2 < n && s[i] == '/' && (s[i+1] == '*' || s[i+1] == '/')) {
+    char c = s[i+1];
+    if(s[i+2] == '!')
+      return 3;
+    size_t j = i+2;
+    while(j < n && s[j] == c)
+      ++j;
+    if(j > i+2)
+      return j - i;
+  }
+  // ' * ', ' */'
+  size_t j = skipSpace(s, n, i);
+  if(j < n && s[j] == '*') {
+    while(j < n && s[j] == '*')
+      ++j;
+    if(j < n && s[j] == '/')
+      ++j;
+    return j - i;
+  }
+  // indentation of the comment
+  if(j - i >= col)
+    return col;
+  return std::string::npos;
+}
+
+// removes the comment prefix of the line [begin, end) of the text
+static std::pair<uint32_t, uint32_t> stripLine(std::string& text, size_t begin, size_t end, unsigned int col) {
+  const char* s = text.data() + begin;
+  size_t n = end - begin;
+  Pieces pieces;
+  size_t i = 0;
+  while(i < n) {
+    size_t prefix = matchLinePrefix(s, n, i, col);
+    size_t j = i + prefix;
+    if(prefix != std::string::npos && j < n && isSpace(s[j]))
+      ++j;
+    size_t lineEnd = prefix == std::string::npos ? i : skipAny(s, n, j);
+    if(lineEnd == i) {
+      pieces.add(begin + i, begin + i + 1);
+      ++i;
+      continue;
+    }
+    pieces.add(begin + j, begin + lineEnd);
+    i = lineEnd;
+  }
+  return pieces.store(text);
+}
+
+// '(?:\{?\.?)(\w+)(?:\}?)' -> '$1' for all matches in [begin, end) of the text
+static std::pair<uint32_t, uint32_t> extractLanguage(std::string& text, size_t begin, size_t end) {
+  const char* s = text.data() + begin;
+  size_t n = end - begin;
+  Pieces pieces;
+  size_t i = 0;
+  while(i < n) {
+    size_t j = i;
+    if(s[j] == '{')
+      ++j;
+    if(j < n && s[j] == '.')
+      ++j;
+    size_t wordEnd = skipWord(s, n, j);
+    if(wordEnd == j) {
+      pieces.add(begin + i, begin + i + 1);
+      ++i;
+      continue;
+    }
+    pieces.add(begin + j, begin + wordEnd);
+    if(wordEnd < n && s[wordEnd] == '}')
+      ++wordEnd;
+    i = wordEnd;
+  }
+  return pieces.store(text);
+}
+
+// -------------------------------------------------
+
+void parseComment(const char* comment, size_t length, const Location& location, CommentBuffer& buffer) {
+  auto& text = buffer.text;
+  auto& tokens = buffer.tokens;
+  const size_t first = tokens.size();
+  const size_t commentStart = text.size();
+  text.append(comment, length);
+  const size_t commentEnd = text.size();
   
-  std::regex defGrpRegex = std::regex(R"((?:@|\\)defgroup\s+(\w+)\s+(.*))");
-  std::regex grpRegex = std::regex(R"((?:@|\\)(addtogroup|ingroup)\s+(\w+))");
-  std::regex mgrpRegex = std::regex(R"((?:@|\\)name\s+(.*))");
-  std::regex deprRegex = std::regex(R"((.*)(?:@|\\)deprecated\s*(.*))");
-  std::regex blockRegex = std::regex(R"(@(\{|\}))");
-  std::regex codeStartRegex = std::regex(R"((?:@|\\)code\s*(.*))");
-  std::regex codeLangRegex = std::regex(R"((?:\{?\.?)(\w+)((?:\}?)))");
-  std::regex codeEndRegex = std::regex(R"((?:@|\\)endcode\s*)");
+  auto addToken = [&](CommentToken::Tag tag, uint32_t line, size_t offset, size_t length) {
+    tokens.emplace_back(tag, line);
+    tokens.back().offset = static_cast<uint32_t>(offset);
+    tokens.back().length = static_cast<uint32_t>(length);
+    return &tokens.back();
+  };
   
-  auto lines = split(comment, "\n");  
-  int i=location.line;
+  uint32_t i=location.line;
   bool codeLine = false;
-  for(auto& line : lines) {
-    line = std::regex_replace(line, lineRegex, "$1");
-    std::smatch match;    
-    if(std::regex_match(line, match, defGrpRegex)) {
-      result.emplace_back(new TDefGroup(i,match[1],match[2]));
-    } else if(std::regex_match(line, match, grpRegex)) {
-      result.emplace_back(new TInGroup(i,match[2]));
-    } else if(std::regex_match(line, match, mgrpRegex)) {
-      result.emplace_back(new TMemberGroup(i,match[1]));
-    } else if(std::regex_match(line, match, blockRegex)) {
-      if(match[1] == "{")
-        result.emplace_back(new TBlockStart(i));
-      else if(match[1] == "}")
-        result.emplace_back(new TBlockEnd(i));
-    } else if(std::regex_match(line, match, deprRegex)) {
-      if(!trim(match[1]).empty())
-        result.emplace_back(new TTextLine(i, escapeMarkdown(match[1])));
-      result.emplace_back(new TDeprecated(i, match[2]));
-    } else if(std::regex_match(line, match, codeStartRegex)) {
-      std::string lang = std::regex_replace(match[1].str(), codeLangRegex, "$1");
-      result.emplace_back(new TCodeBlockStart(i, lang));
+  size_t lineStart = commentStart;
+  while(lineStart <= commentEnd) {
+    size_t lineEnd = text.find('\n', lineStart);
+    if(lineEnd == std::string::npos || lineEnd > commentEnd)
+      lineEnd = commentEnd;
+    auto stripped = stripLine(text, lineStart, lineEnd, location.col);
+    lineStart = lineEnd + 1;
+    const size_t o = stripped.first;
+    const size_t n = stripped.second;
+    const char* line = text.data() + o;
+    
+    size_t p, q, r;
+    bool handled = true;
+    if((p = matchCommand(line, n, 0, "defgroup")) != std::string::npos && 
+        (q = skipSpace(line, n, p)) > p && (r = skipWord(line, n, q)) > q && 
+        skipSpace(line, n, r) > r && isRestAny(line, n, skipSpace(line, n, r))) {
+      // @defgroup <id> <name>
+      size_t nameStart = skipSpace(line, n, r);
+      auto token = addToken(CommentToken::DEF_GROUP, i, o + q, r - q);
+      token->offset2 = static_cast<uint32_t>(o + nameStart);
+      token->length2 = static_cast<uint32_t>(n - nameStart);
+    } else if(((p = matchCommand(line, n, 0, "addtogroup")) != std::string::npos || (p = matchCommand(line, n, 0, "ingroup")) != std::string::npos) &&
+        (q = skipSpace(line, n, p)) > p && (r = skipWord(line, n, q)) > q && r == n) {
+      // @ingroup <id>
+      addToken(CommentToken::IN_GROUP, i, o + q, r - q);
+    } else if((p = matchCommand(line, n, 0, "name")) != std::string::npos && 
+        (q = skipSpace(line, n, p)) > p && isRestAny(line, n, q)) {
+      // @name <member group>
+      addToken(CommentToken::MEMBER_GROUP, i, o + q, n - q);
+    } else if(n == 2 && line[0] == '@' && line[1] == '{') {
+      addToken(CommentToken::BLOCK_START, i, o, 0);
+    } else if(n == 2 && line[0] == '@' && line[1] == '}') {
+      addToken(CommentToken::BLOCK_END, i, o, 0);
+    } else {
+      handled = false;
+    }
+    if(handled) {
+      ++i;
+      continue;
+    }
+    
+    // @deprecated (last occurrence in the line)
+    size_t prefixEnd = skipAny(line, n, 0);
+    bool deprecated = false;
+    for(size_t k = prefixEnd + 1; k-- > 0;) {
+      if((p = matchCommand(line, n, k, "deprecated")) == std::string::npos)
+        continue;
+      q = skipSpace(line, n, p);
+      if(isRestAny(line, n, q)) {
+        if(!isBlank(line, k))
+          addToken(CommentToken::TEXT_LINE, i, o, k);
+        addToken(CommentToken::DEPRECATED, i, o + q, n - q);
+        deprecated = true;
+        break;
+      }
+    }
+    if(deprecated) {
+      ++i;
+      continue;
+    }
+    
+    if((p = matchCommand(line, n, 0, "code")) != std::string::npos && isRestAny(line, n, skipSpace(line, n, p))) {
+      auto lang = extractLanguage(text, o + skipSpace(line, n, p), o + n);
+      addToken(CommentToken::CODE_BLOCK_START, i, lang.first, lang.second);
       codeLine = true;
-    } else if(std::regex_match(line, match, codeEndRegex)) {
-      result.emplace_back(new TCodeBlockEnd(i));
+    } else if((p = matchCommand(line, n, 0, "endcode")) != std::string::npos && skipSpace(line, n, p) == n) {
+      addToken(CommentToken::CODE_BLOCK_END, i, o, 0);
       codeLine = false;
     } else if(codeLine) {
-      result.emplace_back(new TCodeLine(i, line));
+      addToken(CommentToken::CODE_LINE, i, o, n);
     } else {
-      result.emplace_back(new TTextLine(i, escapeMarkdown(line)));
+      addToken(CommentToken::TEXT_LINE, i, o, n);
     }
     ++i;
   }
   // remove first & last empty lines
-  if(!result.empty() && result.front()->getType() == TTextLine::TYPE && trim(result.front()->to<TTextLine>()->text).empty())
-    result.pop_front();
-  if(!result.empty() && result.back()->getType() == TTextLine::TYPE && trim(result.back()->to<TTextLine>()->text).empty())
-    result.pop_back();
-  result.emplace_back(new TCommentEnd(i));
-  return result;
+  auto isEmptyLine = [&](const CommentToken& token) {
+    return token.tag == CommentToken::TEXT_LINE && isBlank(text.data() + token.offset, token.length);
+  };
+  if(tokens.size() > first && isEmptyLine(tokens[first]))
+    tokens.erase(tokens.begin() + first);
+  if(tokens.size() > first && isEmptyLine(tokens.back()))
+    tokens.pop_back();
+  tokens.emplace_back(CommentToken::COMMENT_END, i);
+  // merge consecutive comment blocks
+  if(first > buffer.pos && tokens[first-1].tag == CommentToken::COMMENT_END && tokens[first-1].line == tokens[first].line)
+    tokens.erase(tokens.begin() + (first-1));
 }
 
 } /* WhatsUpDoc */
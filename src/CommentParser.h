@@ -4,102 +4,69 @@
 #include "Helper.h"
 
 #include <string>
-#include <deque>
-#include <memory>
+#include <vector>
+#include <cstdint>
 
 namespace WhatsUpDoc {
-  
-namespace CommentTokens {
-  
-class Token {
-public:
-  static const uint32_t TYPE = 0;
-  const uint32_t type;
-  const uint32_t line;
-  Token(uint32_t line, uint32_t type) : type(type), line(line) {}
-  uint32_t getType() const { return type; }
-  template<class T>
-  T* to() { return static_cast<T*>(this); }
-};
-
-class TTextLine : public Token {
-public:
-  static const uint32_t TYPE = 1;
-  TTextLine(uint32_t line, const std::string& text) : Token(line, TYPE), text(text) {}
-  const std::string text;
-};
-
-class TBlockStart : public Token {
-public:
-  static const uint32_t TYPE = 2;
-  TBlockStart(uint32_t line) : Token(line, TYPE) {}
-};
 
-class TBlockEnd : public Token {
-public:
-  static const uint32_t TYPE = 3;
-  TBlockEnd(uint32_t line) : Token(line, TYPE) {}
-};
-
-class TDefGroup : public Token {
-public:
-  static const uint32_t TYPE = 4;
-  const std::string id;
-  const std::string name;
-  TDefGroup(uint32_t line, const std::string& id, const std::string& name) : Token(line, TYPE), id(id), name(name) {}
+/**
+ * Flat comment token. The text of a token is stored as offset & length into the
+ * text of the CommentBuffer it belongs to.
+ */
+struct CommentToken {
+  enum Tag : uint8_t {
+    TEXT_LINE = 1,
+    BLOCK_START,
+    BLOCK_END,
+    DEF_GROUP,
+    IN_GROUP,
+    MEMBER_GROUP,
+    COMMENT_END,
+    DEPRECATED,
+    CODE_BLOCK_START,
+    CODE_BLOCK_END,
+    CODE_LINE,
+  };
+  Tag tag;
+  uint32_t line;
+  // text line, group id, member group, deprecation note or code language
+  uint32_t offset = 0;
+  uint32_t length = 0;
+  // group name (DEF_GROUP only)
+  uint32_t offset2 = 0;
+  uint32_t length2 = 0;
+  CommentToken(Tag tag, uint32_t line) : tag(tag), line(line) {}
 };
 
-class TInGroup : public Token {
+/**
+ * Comment tokens of an init function together with the comment text they refer to.
+ * Tokens are consumed from the front and released all at once by clear().
+ */
+class CommentBuffer {
 public:
-  static const uint32_t TYPE = 5;
-  const std::string id;
-  TInGroup(uint32_t line, const std::string& id) : Token(line, TYPE), id(id) {}
+  bool empty() const { return pos == tokens.size(); }
+  const CommentToken& front() const { return tokens[pos]; }
+  void popFront() { ++pos; }
+
+  std::string getText(const CommentToken& token) const { return text.substr(token.offset, token.length); }
+  std::string getName(const CommentToken& token) const { return text.substr(token.offset2, token.length2); }
+  // appends the text of the token with escaped markdown characters
+  void appendEscaped(const CommentToken& token, std::string& out) const;
+
+  // keeps the allocated memory for the next init function
+  void clear() { text.clear(); tokens.clear(); pos = 0; }
+private:
+  friend void parseComment(const char* comment, size_t length, const Location& location, CommentBuffer& buffer);
+  std::string text;
+  std::vector<CommentToken> tokens;
+  size_t pos = 0;
 };
 
-class TMemberGroup : public Token {
-public:
-  static const uint32_t TYPE = 6;
-  const std::string id;
-  TMemberGroup(uint32_t line, const std::string& id) : Token(line, TYPE), id(id) {}
-};
-
-class TCommentEnd : public Token {
-public:
-  static const uint32_t TYPE = 7;
-  TCommentEnd(uint32_t line) : Token(line, TYPE) {}
-};
-
-class TDeprecated : public Token {
-public:
-  static const uint32_t TYPE = 8;
-  const std::string description;
-  TDeprecated(uint32_t line, const std::string& descr) : Token(line, TYPE), description(descr) {}
-};
-
-class TCodeBlockStart : public Token {
-public:
-  static const uint32_t TYPE = 9;
-  TCodeBlockStart(uint32_t line, const std::string& lang) : Token(line, TYPE), lang(lang) {}
-  const std::string lang;
-};
-
-class TCodeBlockEnd : public Token {
-public:
-  static const uint32_t TYPE = 10;
-  TCodeBlockEnd(uint32_t line) : Token(line, TYPE) {}
-};
-
-class TCodeLine : public Token {
-public:
-  static const uint32_t TYPE = 11;
-  TCodeLine(uint32_t line, const std::string& text) : Token(line, TYPE), text(text) {}
-  const std::string text;
-};
-
-} /* CommentTokens */
-
-typedef std::unique_ptr<CommentTokens::Token> CommentTokenPtr;
-std::deque<CommentTokenPtr> parseComment(const std::string& comment, const Location& location);
+/**
+ * Tokenizes a doc comment and appends the tokens to the buffer.
+ * The end token of a directly preceding comment block is merged with the new tokens.
+ */
+void parseComment(const char* comment, size_t length, const Location& location, CommentBuffer& buffer);
 
 } /* WhatsUpDoc */
 
@@ -0,0 +1,155 @@
+#include "FileDiscovery.h"
+#include "Helper.h"
+
+#include <EScript/Utils/IO/IO.h>
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace WhatsUpDoc {
+
+// -------------------------------------------------
+
+struct DirectoryWalker {
+  std::vector<WildcardPattern> patterns;
+  std::vector<WildcardPattern> excludePatterns;
+  std::vector<std::string> excludePaths;
+  
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::string> queue;
+  size_t active = 0;
+  std::vector<std::string> result;
+  
+  bool isExcluded(const std::string& path, bool directory) const {
+    for(auto& p : excludePatterns) {
+      if(p.match(path))
+        return true;
+    }
+    if(directory && !excludePaths.empty()) {
+      auto realPath = getRealPath(path);
+      for(auto& e : excludePaths) {
+        if(hasPathPrefix(realPath, e))
+          return true;
+      }
+    }
+    return false;
+  }
+  
+  bool isMatching(const std::string& path) const {
+    for(auto& p : patterns) {
+      if(p.match(path))
+        return true;
+    }
+    return false;
+  }
+  
+  void listDirectory(const std::string& dir, std::vector<std::string>& files, std::vector<std::string>& dirs) const {
+#ifndef _WIN32
+    // a single pass over the directory entries for files & sub-directories
+    DIR* handle = opendir(dir.c_str());
+    if(!handle)
+      return;
+    while(dirent* entry = readdir(handle)) {
+      std::string name = entry->d_name;
+      if(name == "." || name == "..")
+        continue;
+      std::string path = dir + "/" + name;
+      bool isDir = entry->d_type == DT_DIR;
+      bool isFile = entry->d_type == DT_REG;
+      if(entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+        struct stat st;
+        if(stat(path.c_str(), &st) != 0)
+          continue;
+        // do not follow linked directories to avoid cycles
+        isDir = entry->d_type == DT_UNKNOWN && S_ISDIR(st.st_mode);
+        isFile = S_ISREG(st.st_mode);
+      }
+      if(isDir && !isExcluded(path, true))
+        dirs.emplace_back(std::move(path));
+      else if(isFile && isMatching(path) && !isExcluded(path, false))
+        files.emplace_back(std::move(path));
+    }
+    closedir(handle);
+#else
+    for(auto& f : EScript::IO::getFilesInDir(dir, 1)) {
+      if(isMatching(f) && !isExcluded(f, false))
+        files.emplace_back(f);
+    }
+    for(auto& d : EScript::IO::getFilesInDir(dir, 2)) {
+      if(!isExcluded(d, true))
+        dirs.emplace_back(d);
+    }
+#endif
+  }
+  
+  void work() {
+    std::vector<std::string> files;
+    std::vector<std::string> dirs;
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+      changed.wait(lock, [this]() { return !queue.empty() || active == 0; });
+      if(queue.empty())
+        break;
+      std::string dir = std::move(queue.front());
+      queue.pop_front();
+      ++active;
+      lock.unlock();
+      
+      files.clear();
+      dirs.clear();
+      listDirectory(dir, files, dirs);
+      
+      lock.lock();
+      std::move(files.begin(), files.end(), std::back_inserter(result));
+      std::move(dirs.begin(), dirs.end(), std::back_inserter(queue));
+      --active;
+      changed.notify_all();
+    }
+  }
+};
+
+// -------------------------------------------------
+
+std::vector<std::string> findFiles(const std::vector<std::string>& folders, const DiscoveryOptions& options) {
+  DirectoryWalker walker;
+  for(auto& p : options.patterns)
+    walker.patterns.emplace_back(p);
+  for(auto& p : options.excludePatterns)
+    walker.excludePatterns.emplace_back(p);
+  walker.excludePaths = options.excludePaths;
+  
+  unsigned int threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::string> result;
+  std::unordered_set<std::string> known;
+  for(auto& folder : folders) {
+    walker.result.clear();
+    walker.queue.emplace_back(folder);
+    
+    std::vector<std::thread> workers;
+    for(unsigned int i=1; i<threads; ++i)
+      workers.emplace_back(&DirectoryWalker::work, &walker);
+    walker.work();
+    for(auto& worker : workers)
+      worker.join();
+    
+    // the traversal order is not deterministic
+    std::sort(walker.result.begin(), walker.result.end());
+    for(auto& f : walker.result) {
+      if(known.insert(f).second)
+        result.emplace_back(std::move(f));
+    }
+  }
+  return result;
+}
+
+} /* WhatsUpDoc */
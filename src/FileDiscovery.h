@@ -0,0 +1,24 @@
+#ifndef WHATSUPDOC_FILEDISCOVERY_H_
+#define WHATSUPDOC_FILEDISCOVERY_H_
+
+#include <string>
+#include <vector>
+
+namespace WhatsUpDoc {
+
+struct DiscoveryOptions {
+  std::vector<std::string> patterns;        // file name patterns (e.g., *.cpp)
+  std::vector<std::string> excludePatterns; // patterns of excluded files & directories
+  std::vector<std::string> excludePaths;    // excluded path prefixes (real paths)
+  unsigned int threads = 1;
+};
+
+/**
+ * Recursively searches the given folders for files matching one of the patterns.
+ * Folders are walked in parallel, the result is sorted per input folder.
+ */
+std::vector<std::string> findFiles(const std::vector<std::string>& folders, const DiscoveryOptions& options);
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_FILEDISCOVERY_H_ */
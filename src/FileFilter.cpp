@@ -0,0 +1,98 @@
+#include "FileFilter.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace WhatsUpDoc {
+
+// -------------------------------------------------
+
+static inline bool isIdentifierChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static inline bool equals(const char* begin, size_t length, const char* str) {
+  return std::strlen(str) == length && std::memcmp(begin, str, length) == 0;
+}
+
+static bool scanForBindings(const char* data, size_t size) {
+  bool hasInit = false;
+  bool hasNamespace = false;
+  const char* end = data + size;
+  const char* it = data;
+  while(it < end) {
+    if(!isIdentifierChar(*it)) {
+      ++it;
+      continue;
+    }
+    const char* begin = it;
+    while(it < end && isIdentifierChar(*it))
+      ++it;
+    size_t length = it - begin;
+    switch(length) {
+      case 4:
+        hasInit |= equals(begin, length, "init");
+        break;
+      case 9:
+        hasNamespace |= equals(begin, length, "Namespace");
+        break;
+      case 12:
+        if(equals(begin, length, "getClassName"))
+          return true;
+        break;
+      case 15:
+        if(equals(begin, length, "declareFunction") || equals(begin, length, "declareConstant"))
+          return true;
+        break;
+      default: break;
+    }
+    if(hasInit && hasNamespace)
+      return true;
+  }
+  return false;
+}
+
+// -------------------------------------------------
+
+bool mayContainBindings(const std::string& filename) {
+#ifndef _WIN32
+  int fd = open(filename.c_str(), O_RDONLY);
+  if(fd < 0)
+    return true;
+  struct stat st;
+  if(fstat(fd, &st) != 0) {
+    close(fd);
+    return true;
+  }
+  if(st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(data == MAP_FAILED)
+    return true;
+  madvise(data, st.st_size, MADV_SEQUENTIAL);
+  bool result = scanForBindings(reinterpret_cast<const char*>(data), st.st_size);
+  munmap(data, st.st_size);
+  return result;
+#else
+  std::ifstream in(filename, std::ios::binary);
+  if(!in)
+    return true;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  auto content = ss.str();
+  return scanForBindings(content.data(), content.size());
+#endif
+}
+
+} /* WhatsUpDoc */
@@ -0,0 +1,18 @@
+#ifndef WHATSUPDOC_FILEFILTER_H_
+#define WHATSUPDOC_FILEFILTER_H_
+
+#include <string>
+
+namespace WhatsUpDoc {
+
+/**
+ * Fast lexical scan of a source file for the identifiers the parser reacts on 
+ * (init(EScript::Namespace*), declareFunction, declareConstant & getClassName).
+ * Files without any of them can not contribute to the documentation.
+ * Returns true if the file can not be read.
+ */
+bool mayContainBindings(const std::string& filename);
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_FILEFILTER_H_ */
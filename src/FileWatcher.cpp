@@ -0,0 +1,193 @@
+#include "FileWatcher.h"
+#include "Helper.h"
+
+#include <EScript/Utils/IO/IO.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace WhatsUpDoc {
+
+// interval for polling the modification times in milliseconds
+static const int POLL_INTERVAL = 250;
+
+static time_t getModificationTime(const std::string& path) {
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+// real paths of the folders & all of their sub-folders
+static std::vector<std::string> getFolders(const std::vector<std::string>& folders) {
+  std::vector<std::string> result;
+  std::unordered_set<std::string> visited;
+  std::vector<std::string> queue(folders.begin(), folders.end());
+  while(!queue.empty()) {
+    // linked folders might form cycles
+    std::string dir = getRealPath(queue.back());
+    queue.pop_back();
+    if(!visited.insert(dir).second)
+      continue;
+    for(auto& d : EScript::IO::getFilesInDir(dir, 2))
+      queue.emplace_back(d);
+    result.emplace_back(std::move(dir));
+  }
+  return result;
+}
+
+// -------------------------------------------------
+
+FileWatcher::FileWatcher() {
+#ifdef __linux__
+  fd = inotify_init1(IN_CLOEXEC);
+  if(fd < 0)
+    std::cerr << "inotify is not available, polling for changes." << std::endl;
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+  if(fd >= 0)
+    close(fd);
+#endif
+}
+
+// -------------------------------------------------
+
+void FileWatcher::setFiles(const std::vector<std::string>& newFiles, const std::vector<std::string>& folders) {
+  files.clear();
+  files.insert(newFiles.begin(), newFiles.end());
+  times.clear();
+  auto watchedFolders = getFolders(folders);
+#ifdef __linux__
+  if(fd >= 0) {
+    for(auto& v : directories)
+      inotify_rm_watch(fd, v.first);
+    directories.clear();
+    std::unordered_map<std::string, bool> dirs;
+    for(auto& file : files) {
+      auto pos = file.find_last_of('/');
+      if(pos != std::string::npos)
+        dirs.emplace(pos == 0 ? "/" : file.substr(0, pos), false);
+    }
+    for(auto& dir : watchedFolders)
+      dirs[dir] = true;
+    std::unordered_set<std::string> failed;
+    for(auto& dir : dirs) {
+      int wd = inotify_add_watch(fd, dir.first.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+      if(wd >= 0)
+        directories[wd] = {dir.first, dir.second};
+      else
+        failed.insert(dir.first);
+    }
+    if(failed.empty())
+      return;
+    // e.g., the limit of watches is reached
+    std::cerr << "could not watch " << failed.size() << " folders, polling them for changes." << std::endl;
+    for(auto& file : files) {
+      auto pos = file.find_last_of('/');
+      if(pos != std::string::npos && failed.count(pos == 0 ? "/" : file.substr(0, pos)) > 0)
+        times[file] = getModificationTime(file);
+    }
+    for(auto& dir : watchedFolders) {
+      if(failed.count(dir) > 0)
+        times[dir] = getModificationTime(dir);
+    }
+    return;
+  }
+#endif
+  for(auto& file : files)
+    times[file] = getModificationTime(file);
+  for(auto& dir : watchedFolders)
+    times[dir] = getModificationTime(dir);
+}
+
+// -------------------------------------------------
+
+// polled files & folders with a changed modification time, a folder changes if entries are created or removed
+void FileWatcher::checkTimes(std::vector<std::string>& changed) {
+  for(auto& v : times) {
+    auto time = getModificationTime(v.first);
+    if(time != v.second) {
+      v.second = time;
+      changed.emplace_back(v.first);
+    }
+  }
+}
+
+#ifdef __linux__
+// collects the watched files & the created entries of the pending events (all of them on an overflow),
+// returns false if there were none
+bool FileWatcher::readEvents(std::vector<std::string>& changed) {
+  alignas(struct inotify_event) char buffer[16*1024];
+  ssize_t length = read(fd, buffer, sizeof(buffer));
+  for(ssize_t i=0; i<length;) {
+    auto event = reinterpret_cast<const struct inotify_event*>(buffer + i);
+    i += sizeof(struct inotify_event) + event->len;
+    if(event->mask & IN_Q_OVERFLOW) {
+      // events were lost, everything might have changed
+      std::cerr << "inotify queue overflow, reloading all files." << std::endl;
+      changed.insert(changed.end(), files.begin(), files.end());
+      for(auto& v : directories) {
+        if(v.second.reportCreated)
+          changed.emplace_back(v.second.path);
+      }
+      continue;
+    }
+    auto dir = directories.find(event->wd);
+    if(dir == directories.end() || event->len == 0)
+      continue;
+    std::string path = (dir->second.path == "/" ? "" : dir->second.path) + "/" + event->name;
+    if(files.count(path) > 0 || (dir->second.reportCreated && (event->mask & (IN_CREATE | IN_MOVED_TO))))
+      changed.emplace_back(path);
+  }
+  return length > 0;
+}
+#endif
+
+// waits up to timeout milliseconds (-1 for no limit), returns false if nothing happened
+bool FileWatcher::collect(int timeout, std::vector<std::string>& changed) {
+  size_t count = changed.size();
+  bool events = false;
+#ifdef __linux__
+  bool polling = fd < 0 || !times.empty();
+#else
+  bool polling = true;
+#endif
+  if(polling && (timeout < 0 || timeout > POLL_INTERVAL))
+    timeout = POLL_INTERVAL;
+#ifdef __linux__
+  if(fd >= 0) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    if(::poll(&pfd, 1, timeout) > 0)
+      events = readEvents(changed);
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::max(timeout, 0)));
+  }
+#else
+  std::this_thread::sleep_for(std::chrono::milliseconds(std::max(timeout, 0)));
+#endif
+  checkTimes(changed);
+  return events || changed.size() > count;
+}
+
+std::vector<std::string> FileWatcher::wait(int settle) {
+  std::vector<std::string> changed;
+  while(changed.empty())
+    collect(-1, changed);
+  while(collect(settle, changed)) {}
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  return changed;
+}
+
+} /* WhatsUpDoc */
@@ -0,0 +1,48 @@
+#ifndef WHATSUPDOC_FILEWATCHER_H_
+#define WHATSUPDOC_FILEWATCHER_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <ctime>
+
+namespace WhatsUpDoc {
+
+/**
+ * Reports changes of a set of files. On Linux the parent directories are watched
+ * with inotify (editors often replace files instead of writing them), on other
+ * platforms or if inotify is not available the modification times are polled.
+ */
+class FileWatcher {
+public:
+  FileWatcher();
+  ~FileWatcher();
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  // replaces the set of watched files (real paths), entries created in the folders
+  // (or their sub-folders) are reported as well
+  void setFiles(const std::vector<std::string>& files, const std::vector<std::string>& folders={});
+  // blocks until at least one file changed, changes within the next settle milliseconds are reported together
+  std::vector<std::string> wait(int settle=50);
+private:
+  bool collect(int timeout, std::vector<std::string>& changed);
+  void checkTimes(std::vector<std::string>& changed);
+  std::unordered_set<std::string> files;
+  // polled files & folders
+  std::unordered_map<std::string, time_t> times;
+#ifdef __linux__
+  bool readEvents(std::vector<std::string>& changed);
+  int fd = -1;
+  struct Directory {
+    std::string path;
+    bool reportCreated;
+  };
+  std::unordered_map<int, Directory> directories;
+#endif
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_FILEWATCHER_H_ */
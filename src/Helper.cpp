@@ -1,10 +1,21 @@
 #include "Helper.h"
+#include "TokenIndex.h"
 
 #include <EScript/Utils/StringUtils.h>
 
-#include <regex>
 #include <iostream>
 #include <sstream>
+#include <mutex>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <atomic>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace WhatsUpDoc {
 
@@ -16,7 +27,7 @@ std::ostream& operator<<(std::ostream& stream, const CXString& str) {
 // -------------------------------------------------
 
 std::ostream& operator<<(std::ostream& stream, const EScript::StringId& str) {
-  stream << str.toString();
+  stream << toString(str);
   return stream;
 }
 
@@ -52,6 +63,25 @@ std::string toString(const CXString& str) {
 
 // -------------------------------------------------
 
+static std::mutex& getStringIdMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+EScript::StringId toStringId(const std::string& str) {
+  if(str.empty())
+    return EScript::StringId();
+  std::lock_guard<std::mutex> lock(getStringIdMutex());
+  return EScript::StringId(str);
+}
+
+const std::string& toString(const EScript::StringId& id) {
+  std::lock_guard<std::mutex> lock(getStringIdMutex());
+  return id.toString();
+}
+
+// -------------------------------------------------
+
 bool isLiteral(CXCursorKind kind) {  
   switch(kind) {
     case CXCursor_IntegerLiteral:
@@ -67,37 +97,8 @@ bool isLiteral(CXCursorKind kind) {
 
 // -------------------------------------------------
 
-bool hasType(CXCursor cursor, const std::string& name) {
-  auto type = clang_getCursorType(cursor);
-  auto spelling = toString(clang_getTypeSpelling(type));
-  return spelling.find(name) != std::string::npos;
-}
-
-// -------------------------------------------------
-
-CXChildVisitResult getCursorRefVisitor(CXCursor cursor, CXCursor parent, CXClientData client_data) {
-  CXCursorKind kind = clang_getCursorKind(cursor);
-  auto name = toString(clang_getCursorSpelling(cursor));
-  
-  //*reinterpret_cast<CXCursor*>(client_data) = clang_getNullCursor();
-  switch (kind) {
-    case CXCursor_DeclRefExpr:
-      *reinterpret_cast<CXCursor*>(client_data) = cursor;
-      return CXChildVisit_Break;
-    default: break;
-  }
-  return CXChildVisit_Recurse;
-}
-
-CXCursor getCursorRef(CXCursor cursor) {
-  if(clang_getCursorKind(cursor) == CXCursor_DeclRefExpr)
-    return clang_getCursorReferenced(cursor);
-  CXCursor refCursor = clang_getNullCursor();
-  clang_visitChildren(cursor, *getCursorRefVisitor, &refCursor);
-  if(!clang_Cursor_isNull(refCursor)) {
-    return clang_getCursorReferenced(refCursor);
-  }
-  return clang_getNullCursor();
+EScript::StringId getCursorId(CXCursor cursor) {
+  return toStringId(toString(clang_getCursorUSR(cursor)));
 }
 
 // -------------------------------------------------
@@ -113,33 +114,15 @@ Location getCursorLocation(CXCursor cursor) {
 
 // -------------------------------------------------
 
-Location getTokenLocation(CXTranslationUnit tu, CXToken token) {
-  Location loc;
-  CXString filename;
-  CXSourceLocation location = clang_getTokenLocation(tu, token);
-  clang_getPresumedLocation(location, &filename, &loc.line, &loc.col);
-  loc.file = toString(filename);
-  return loc;
-}
-
-// -------------------------------------------------
-
-int extractIntLiteral(CXCursor cursor) {
-  CXSourceRange range = clang_getCursorExtent(cursor);
-  CXTranslationUnit tu = clang_Cursor_getTranslationUnit(cursor);
-  CXToken *tokens = 0;
-  unsigned int nTokens = 0;
-  clang_tokenize(tu, range, &tokens, &nTokens);
+int extractIntLiteral(CXCursor cursor, TokenIndex& index) {
   int value = 0;
-  for (unsigned int i = 0; i < nTokens; i++) {
-    std::string spelling = toString(clang_getTokenSpelling(tu, tokens[i]));
-    if(clang_getTokenKind(tokens[i]) == CXToken_Literal && spelling.find('\"') == std::string::npos) {
-      std::stringstream ss(spelling);
+  for(auto& token : index.getTokens(cursor)) {
+    if(token.kind == CXToken_Literal && std::memchr(token.spelling, '\"', token.length) == nullptr) {
+      std::stringstream ss(std::string(token.spelling, token.length));
       ss >> value;
       break;
     }
   }
-  clang_disposeTokens(tu, tokens, nTokens);
   return value;
 }
 
@@ -155,21 +138,14 @@ CXChildVisitResult extractStringLiteralVisitor(CXCursor cursor, CXCursor parent,
   return CXChildVisit_Recurse;
 }
 
-std::string extractStringLiteral(CXCursor cursor) {
-  CXSourceRange range = clang_getCursorExtent(cursor);
-  CXTranslationUnit tu = clang_Cursor_getTranslationUnit(cursor);
-  CXToken *tokens = 0;
-  unsigned int nTokens = 0;
-  clang_tokenize(tu, range, &tokens, &nTokens);
+std::string extractStringLiteral(CXCursor cursor, TokenIndex& index) {
   std::string value;
-  for (unsigned int i = 0; i < nTokens; i++) {
-    std::string spelling = toString(clang_getTokenSpelling(tu, tokens[i]));
-    if(clang_getTokenKind(tokens[i]) == CXToken_Literal && spelling.find('\"') != std::string::npos) {
-      value = spelling;
+  for(auto& token : index.getTokens(cursor)) {
+    if(token.kind == CXToken_Literal && std::memchr(token.spelling, '\"', token.length) != nullptr) {
+      value.assign(token.spelling, token.length);
       break;
     }
   }
-  clang_disposeTokens(tu, tokens, nTokens);
   if(value.empty()) {
     clang_visitChildren(cursor, *extractStringLiteralVisitor, &value);
   }
@@ -230,7 +206,7 @@ void printTokens(CXCursor cursor, int indent) {
 
 std::string toJSONFilename(const EScript::StringId& id) {
   using namespace EScript::StringUtils;
-  std::string file = id.toString();
+  std::string file = toString(id);
   file = replaceAll(file,"@","_");
   file = replaceAll(file,":","_");
   file = replaceAll(file,".","_");
@@ -245,113 +221,104 @@ std::string toJSONFilename(const EScript::StringId& id) {
 
 // -------------------------------------------------
 
-struct FindResult {
-  CXCursor cursor;
-  int kind;
-  std::string name;
-  std::string type;
-};
-
-CXChildVisitResult findCursorVisitor(CXCursor cursor, CXCursor parent, CXClientData client_data) {
-  auto name = toString(clang_getCursorSpelling(cursor));
+std::string getFullyQualifiedName(CXCursor cursor) {
+  std::string name = "";
   CXCursorKind kind = clang_getCursorKind(cursor);
-  auto type = toString(clang_getTypeSpelling(clang_getCursorType(cursor)));
-  auto* result = reinterpret_cast<FindResult*>(client_data);  
-  if(
-    (result->kind == 0 || result->kind == kind) &&
-    (result->name.empty() || name == result->name) &&
-    (result->type.empty() || type.find(result->type) != std::string::npos)
-  ) {
-    result->cursor = cursor;
-    return CXChildVisit_Break;
+  if(!clang_Cursor_isNull(cursor) && kind != CXCursor_TranslationUnit) {
+    name = getFullyQualifiedName(clang_getCursorSemanticParent(cursor));
+    if(!name.empty())
+      name += "::";
+    name += toString(clang_getCursorSpelling(cursor));
   }
-  return CXChildVisit_Recurse;
-}
-
-CXCursor findCursor(CXCursor cursor, const std::string& name, int kind, const std::string& type, bool includeSelf) {
-  FindResult result{clang_getNullCursor(), kind, name, type};
-  if(!includeSelf || findCursorVisitor(cursor, clang_getNullCursor(), &result) != CXChildVisit_Break)
-    clang_visitChildren(cursor, *findCursorVisitor, &result);
-  return result.cursor;
+  return name;
 }
 
 // -------------------------------------------------
 
-CXCursor findRef(CXCursor cursor, const std::string& name) {
-  CXCursor call = findCursor(cursor, name, CXCursor_MemberRefExpr);
-  if(clang_Cursor_isNull(call))
-    call = findCursor(cursor, name, CXCursor_DeclRefExpr);
-  if(!clang_Cursor_isNull(call)) {
-    return clang_getCursorReferenced(call);
+WildcardPattern::WildcardPattern(const std::string& pattern) : mode(GENERIC), pattern(pattern) {
+  auto wildcards = pattern.find_first_of("*?");
+  if(wildcards == std::string::npos) {
+    mode = EXACT;
+    literal = pattern;
+  } else if(pattern[0] == '*' && pattern.find_first_of("*?", 1) == std::string::npos) {
+    mode = SUFFIX;
+    literal = pattern.substr(1);
+  } else if(wildcards == pattern.size()-1 && pattern.back() == '*') {
+    mode = PREFIX;
+    literal = pattern.substr(0, pattern.size()-1);
   }
-  return call;
 }
 
-// -------------------------------------------------
-
-CXCursor findTypeRef(CXCursor cursor, const std::string& type) {
-  CXCursor typeCursor = findCursor(cursor, "", CXCursor_MemberRefExpr, type);
-  if(clang_Cursor_isNull(typeCursor))
-    typeCursor = findCursor(cursor, "", CXCursor_DeclRefExpr, type);
-  if(!clang_Cursor_isNull(typeCursor))
-    return clang_getCursorReferenced(typeCursor);
-  return typeCursor;
+bool WildcardPattern::match(const std::string& input) const {
+  switch(mode) {
+    case EXACT:
+      return input == literal;
+    case PREFIX:
+      return input.compare(0, literal.size(), literal) == 0;
+    case SUFFIX:
+      return input.size() >= literal.size() && input.compare(input.size() - literal.size(), literal.size(), literal) == 0;
+    default: break;
+  }
+  // greedy matching with backtracking to the last '*'
+  size_t i = 0, p = 0;
+  size_t starP = std::string::npos, starI = 0;
+  while(i < input.size()) {
+    if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == input[i])) {
+      ++i; ++p;
+    } else if(p < pattern.size() && pattern[p] == '*') {
+      starP = p++;
+      starI = i;
+    } else if(starP != std::string::npos) {
+      p = starP + 1;
+      i = ++starI;
+    } else {
+      return false;
+    }
+  }
+  while(p < pattern.size() && pattern[p] == '*')
+    ++p;
+  return p == pattern.size();
 }
 
 // -------------------------------------------------
 
-CXChildVisitResult findExposedVisitor(CXCursor cursor, CXCursor parent, CXClientData client_data) {
-  CXCursorKind kind = clang_getCursorKind(cursor);
-  switch(kind) {
-    case CXCursor_UnexposedAttr:
-    case CXCursor_UnexposedDecl:
-    case CXCursor_UnexposedExpr:
-    case CXCursor_UnexposedStmt:
-    case CXCursor_UnaryOperator: // also skip * &
-      return CXChildVisit_Recurse;
-    default: break;
-  }
-  // also skip RtValue
-  if(hasType(cursor, "EScript::RtValue"))
-    return CXChildVisit_Recurse;
-  auto* result = reinterpret_cast<FindResult*>(client_data);
-  result->cursor = cursor;
-  return CXChildVisit_Break;
+bool matchWildcard(const std::string& input, const std::string& pattern) {
+  return WildcardPattern(pattern).match(input);
 }
 
-CXCursor findExposed(CXCursor cursor) {
-  FindResult result{clang_getNullCursor(), 0, "", ""};
-  if(findExposedVisitor(cursor, clang_getNullCursor(), &result) != CXChildVisit_Break)
-    clang_visitChildren(cursor, *findExposedVisitor, &result);
-  return result.cursor;
+// -------------------------------------------------
+
+std::string getRealPath(const std::string& path) {
+#ifdef _WIN32
+  char buffer[_MAX_PATH];
+  if(_fullpath(buffer, path.c_str(), _MAX_PATH))
+    return EScript::StringUtils::replaceAll(buffer, "\\", "/");
+#else
+  char buffer[PATH_MAX];
+  if(realpath(path.c_str(), buffer))
+    return buffer;
+#endif
+  return path;
 }
 
 // -------------------------------------------------
 
-std::string getFullyQualifiedName(CXCursor cursor) {
-  std::string name = "";
-  CXCursorKind kind = clang_getCursorKind(cursor);
-  if(!clang_Cursor_isNull(cursor) && kind != CXCursor_TranslationUnit) {
-    name = getFullyQualifiedName(clang_getCursorSemanticParent(cursor));
-    if(!name.empty())
-      name += "::";
-    name += toString(clang_getCursorSpelling(cursor));
-  }
-  return name;
+bool hasPathPrefix(const std::string& path, const std::string& prefix) {
+  if(prefix.empty() || path.compare(0, prefix.size(), prefix) != 0)
+    return false;
+  return path.size() == prefix.size() || path[prefix.size()] == '/' || prefix.back() == '/';
 }
 
 // -------------------------------------------------
 
-bool matchWildcard(const std::string& input, const std::string& pattern) {
-  using namespace EScript::StringUtils;
-  std::string pat = pattern;
-  pat = replaceAll(pat,"\\","\\\\");
-  pat = replaceAll(pat,".","\\.");
-  pat = replaceAll(pat,"/","\\/");
-  pat = replaceAll(pat,"?",".");
-  pat = replaceAll(pat,"*",".*");
-  pat = "^" + pat + "$";
-  return std::regex_match(input, std::regex(pat));
+std::string getTempPath(const std::string& path) {
+  static std::atomic<uint32_t> counter(0);
+#ifdef _WIN32
+  int pid = _getpid();
+#else
+  int pid = static_cast<int>(getpid());
+#endif
+  return path + "." + std::to_string(pid) + "." + std::to_string(counter++) + ".tmp";
 }
 
 // -------------------------------------------------
@@ -1,17 +1,16 @@
 #ifndef WHATSUPDOC_HELPER_H_
 #define WHATSUPDOC_HELPER_H_
 
+#include "Location.h"
+
 #include <EScript/Utils/StringId.h>
 #include <clang-c/Index.h>
 #include <string>
+#include <vector>
 #include <ostream>
 
 namespace WhatsUpDoc {
-struct Location {
-  std::string file;
-  unsigned int line;
-  unsigned int col;
-};
+class TokenIndex;
 
 std::ostream& operator<<(std::ostream& stream, const CXString& str);
 std::ostream& operator<<(std::ostream& stream, const EScript::StringId& str);
@@ -19,31 +18,43 @@ std::ostream& operator<<(std::ostream& stream, const Location& loc);
 std::ostream& operator<<(std::ostream& stream, const CXCursor& cursor);
 std::string toString(const CXString& str);
 
-bool isLiteral(CXCursorKind kind);
+// thread safe access to the global EScript::StringId table
+EScript::StringId toStringId(const std::string& str);
+const std::string& toString(const EScript::StringId& id);
 
-bool hasType(CXCursor cursor, const std::string& name);
+bool isLiteral(CXCursorKind kind);
 
-CXCursor getCursorRef(CXCursor cursor);
+EScript::StringId getCursorId(CXCursor cursor);
 
 Location getCursorLocation(CXCursor cursor);
-Location getTokenLocation(CXTranslationUnit tu, CXToken token);
 
-int extractIntLiteral(CXCursor cursor);
-std::string extractStringLiteral(CXCursor cursor);
+// literals are looked up in the tokens of the translation unit
+int extractIntLiteral(CXCursor cursor, TokenIndex& index);
+std::string extractStringLiteral(CXCursor cursor, TokenIndex& index);
 void printCursor(CXCursor cursor, int indent=0);
 void printAST(CXCursor cursor, int indent=0);
 void printTokens(CXCursor cursor, int indent=0);
 std::string toJSONFilename(const EScript::StringId& id);
 
-CXCursor findCursor(CXCursor cursor, const std::string& name="", int kind=0, const std::string& type="", bool includeSelf=true);
-
-CXCursor findRef(CXCursor cursor, const std::string& name);
-CXCursor findTypeRef(CXCursor cursor, const std::string& type);
-CXCursor findExposed(CXCursor cursor);
-
 std::string getFullyQualifiedName(CXCursor cursor);
 
+// wildcard pattern ('*' & '?') that is analyzed once and matched without regex
+class WildcardPattern {
+public:
+  WildcardPattern(const std::string& pattern);
+  bool match(const std::string& input) const;
+private:
+  enum {EXACT, PREFIX, SUFFIX, GENERIC} mode;
+  std::string pattern;
+  std::string literal;
+};
+
 bool matchWildcard(const std::string& input, const std::string& pattern);
+
+std::string getRealPath(const std::string& path);
+bool hasPathPrefix(const std::string& path, const std::string& prefix);
+// unique name (per process & call) of a temporary file next to the path, e.g., to replace it by rename()
+std::string getTempPath(const std::string& path);
 } /* WhatsUpDoc */
 
 #endif /* end of include guard: WHATSUPDOC_HELPER_H_ */
@@ -0,0 +1,124 @@
+#include "JsonExport.h"
+#include "JsonWriter.h"
+#include "ParsingContext.h"
+
+#include <cstring>
+
+namespace WhatsUpDoc {
+
+// -------------------------------------------------
+
+const char* getKindName(const Compound& cmp) {
+  switch(cmp.kind) {
+    case Compound::NAMESPACE: return "namespace";
+    case Compound::TYPE: return "type";
+    case Compound::GROUP: return "group";
+    default: return "unknown";
+  }
+}
+
+// -------------------------------------------------
+
+static void writeLocation(JsonWriter& writer, const Location& loc) {
+  writer.beginString();
+  writer.appendString(loc.file);
+  writer.appendString(":", 1);
+  writer.appendNumber(loc.line);
+  writer.appendString(":", 1);
+  writer.appendNumber(loc.col);
+  writer.endString();
+}
+
+// id of a compound, empty if the compound is unnamed
+static void writeRef(JsonWriter& writer, const EScript::StringId& id, const ParsingContext* context) {
+  if(findCompound(id, context).name.empty())
+    writer.value("", 0);
+  else
+    writer.value(toString(id));
+}
+
+static void writeFullname(JsonWriter& writer, const EScript::StringId& owner, const std::string& name, const ParsingContext* context) {
+  writer.beginString();
+  writer.appendString(findCompound(owner, context).fullname);
+  writer.appendString(".", 1);
+  writer.appendString(name);
+  writer.endString();
+}
+
+// -------------------------------------------------
+
+void writeCompoundJSON(JsonWriter& writer, const Compound& cmp, const ParsingContext* context) {
+  writer.beginObject();
+  writer.key("id");
+  writer.value(toString(cmp.id));
+  writer.key("name");
+  writer.value(cmp.name);
+  writer.key("fullname");
+  writer.value(cmp.fullname);
+  const char* kind = getKindName(cmp);
+  writer.key("kind");
+  writer.value(kind, std::strlen(kind));
+  writer.key("location");
+  writeLocation(writer, cmp.location);
+  writer.key("parent");
+  writeRef(writer, cmp.parentId, context);
+  writer.key("group");
+  writeRef(writer, cmp.group, context);
+  writer.key("base");
+  writeRef(writer, cmp.base, context);
+  writer.key("description");
+  writer.value(cmp.decription);
+  
+  writer.key("children");
+  writer.beginArray();
+  for(auto h : cmp.children) {
+    auto& v = context->references[h];
+    writer.beginObject();
+    writer.key("name");
+    writer.value(v.name);
+    writer.key("fullname");
+    writeFullname(writer, v.compound, v.name, context);
+    writer.key("ref");
+    writer.value(toString(v.ref));
+    writer.key("location");
+    writeLocation(writer, v.location);
+    writer.endObject();
+  }
+  writer.endArray();
+  
+  writer.key("member");
+  writer.beginArray();
+  for(auto h : cmp.member) {
+    auto& v = context->members[h];
+    writer.beginObject();
+    writer.key("name");
+    writer.value(v.name);
+    writer.key("fullname");
+    writeFullname(writer, v.compound, v.name, context);
+    writer.key("kind");
+    switch(v.kind) {
+      case Member::CONST: writer.value("const", 5); break;
+      case Member::FUNCTION: writer.value("function", 8); break;
+      default: writer.value("unknown", 7); break;
+    }
+    writer.key("minParams");
+    writer.number(v.minParams);
+    writer.key("maxParams");
+    writer.number(v.maxParams);
+    writer.key("location");
+    writeLocation(writer, v.location);
+    writer.key("description");
+    writer.value(v.description);
+    writer.key("cpp");
+    writer.value(v.cppRef);
+    writer.key("group");
+    writer.value(v.group);
+    writer.key("deprecated");
+    writer.boolean(v.deprecated);
+    writer.endObject();
+  }
+  writer.endArray();
+  writer.endObject();
+}
+
+} /* WhatsUpDoc */
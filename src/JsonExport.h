@@ -0,0 +1,17 @@
+#ifndef WHATSUPDOC_JSONEXPORT_H_
+#define WHATSUPDOC_JSONEXPORT_H_
+
+namespace WhatsUpDoc {
+class JsonWriter;
+struct Compound;
+struct ParsingContext;
+
+// kind of the compound as used in file names & documents
+const char* getKindName(const Compound& cmp);
+
+// writes the document of a compound, the full names have to be computed before
+void writeCompoundJSON(JsonWriter& writer, const Compound& cmp, const ParsingContext* context);
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_JSONEXPORT_H_ */
@@ -0,0 +1,210 @@
+#include "JsonWriter.h"
+
+#include <cstring>
+#include <cmath>
+
+namespace WhatsUpDoc {
+
+JsonWriter::JsonWriter(size_t bufferSize) : buffer(bufferSize < 64 ? 64 : bufferSize) {
+  empty.reserve(16);
+}
+
+JsonWriter::~JsonWriter() {
+  if(file || target)
+    close();
+}
+
+// -------------------------------------------------
+
+bool JsonWriter::open(const std::string& path) {
+  if(!open(std::fopen(path.c_str(), "wb")))
+    return false;
+  ownsFile = true;
+  return true;
+}
+
+bool JsonWriter::open(FILE* out) {
+  if(file || target)
+    close();
+  file = out;
+  target = nullptr;
+  ownsFile = false;
+  pos = 0;
+  written = 0;
+  failed = false;
+  empty.clear();
+  afterKey = false;
+  return file != nullptr;
+}
+
+void JsonWriter::open(std::string& out) {
+  open(nullptr);
+  target = &out;
+}
+
+bool JsonWriter::close() {
+  if(!file && !target)
+    return false;
+  put('\n');
+  flush();
+  if(file && (ownsFile ? std::fclose(file) != 0 : std::fflush(file) != 0))
+    failed = true;
+  file = nullptr;
+  target = nullptr;
+  return !failed;
+}
+
+// -------------------------------------------------
+
+void JsonWriter::flush() {
+  if(target)
+    target->append(buffer.data(), pos);
+  else if(file && pos > 0 && std::fwrite(buffer.data(), 1, pos, file) != pos)
+    failed = true;
+  written += pos;
+  pos = 0;
+}
+
+void JsonWriter::write(const char* data, size_t length) {
+  if(length > buffer.size() - pos) {
+    flush();
+    if(length >= buffer.size()) {
+      if(target)
+        target->append(data, length);
+      else if(file && std::fwrite(data, 1, length, file) != length)
+        failed = true;
+      written += length;
+      return;
+    }
+  }
+  std::memcpy(buffer.data() + pos, data, length);
+  pos += length;
+}
+
+void JsonWriter::writeEscaped(const char* str, size_t length) {
+  static const char hex[] = "0123456789abcdef";
+  size_t run = 0;
+  for(size_t i=0; i<length; ++i) {
+    unsigned char c = static_cast<unsigned char>(str[i]);
+    if(c >= 0x20 && c != '"' && c != '\\')
+      continue;
+    write(str + run, i - run);
+    run = i + 1;
+    put('\\');
+    switch(c) {
+      case '"': put('"'); break;
+      case '\\': put('\\'); break;
+      case '\n': put('n'); break;
+      case '\r': put('r'); break;
+      case '\t': put('t'); break;
+      case '\b': put('b'); break;
+      case '\f': put('f'); break;
+      default: {
+        char code[5] = {'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+        write(code, 5);
+      }
+    }
+  }
+  write(str + run, length - run);
+}
+
+// -------------------------------------------------
+
+// comma, line break & indentation in front of an entry of the current container
+void JsonWriter::separate() {
+  if(afterKey) {
+    afterKey = false;
+    return;
+  }
+  if(empty.empty())
+    return;
+  if(!empty.back())
+    put(',');
+  empty.back() = false;
+  put('\n');
+  for(size_t i=0; i<empty.size(); ++i)
+    write("  ", 2);
+}
+
+void JsonWriter::beginContainer(char c) {
+  separate();
+  put(c);
+  empty.push_back(true);
+}
+
+void JsonWriter::endContainer(char c) {
+  bool wasEmpty = empty.back();
+  empty.pop_back();
+  if(!wasEmpty) {
+    put('\n');
+    for(size_t i=0; i<empty.size(); ++i)
+      write("  ", 2);
+  }
+  put(c);
+}
+
+void JsonWriter::beginObject() { beginContainer('{'); }
+void JsonWriter::endObject() { endContainer('}'); }
+void JsonWriter::beginArray() { beginContainer('['); }
+void JsonWriter::endArray() { endContainer(']'); }
+
+void JsonWriter::key(const char* name) {
+  separate();
+  put('"');
+  writeEscaped(name, std::strlen(name));
+  write("\" : ", 4);
+  afterKey = true;
+}
+
+// -------------------------------------------------
+
+void JsonWriter::value(const char* str, size_t length) {
+  beginString();
+  writeEscaped(str, length);
+  endString();
+}
+
+void JsonWriter::number(int64_t value) {
+  separate();
+  appendNumber(value);
+}
+
+void JsonWriter::real(double value) {
+  separate();
+  if(!std::isfinite(value)) {
+    write("null", 4);
+    return;
+  }
+  char digits[32];
+  int length = std::snprintf(digits, sizeof(digits), "%.9g", value);
+  write(digits, static_cast<size_t>(length));
+}
+
+void JsonWriter::boolean(bool value) {
+  separate();
+  if(value)
+    write("true", 4);
+  else
+    write("false", 5);
+}
+
+void JsonWriter::beginString() {
+  separate();
+  put('"');
+}
+
+void JsonWriter::appendNumber(int64_t value) {
+  char digits[24];
+  size_t n = 0;
+  uint64_t v = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+  do {
+    digits[n++] = static_cast<char>('0' + v % 10);
+    v /= 10;
+  } while(v != 0);
+  if(value < 0)
+    put('-');
+  while(n > 0)
+    put(digits[--n]);
+}
+
+} /* WhatsUpDoc */
@@ -0,0 +1,78 @@
+#ifndef WHATSUPDOC_JSONWRITER_H_
+#define WHATSUPDOC_JSONWRITER_H_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+
+/**
+ * Buffered streaming writer for indented JSON documents. Separators are emitted
+ * on demand, so the output never contains trailing commas. The writer can be
+ * reused for several documents without further allocations.
+ */
+class JsonWriter {
+public:
+  explicit JsonWriter(size_t bufferSize = 64*1024);
+  ~JsonWriter();
+
+  // starts a new document, returns false if the file could not be opened
+  bool open(const std::string& path);
+  // starts a new document at the current position of an open file, which is not closed by close()
+  bool open(FILE* out);
+  // starts a new document that is appended to the string
+  void open(std::string& out);
+  // finishes the document, returns false if writing failed
+  bool close();
+  // bytes of the current document including the buffered ones
+  uint64_t getSize() const { return written + pos; }
+
+  void beginObject();
+  void endObject();
+  void beginArray();
+  void endArray();
+  void key(const char* name);
+
+  void value(const std::string& str) { value(str.data(), str.size()); }
+  void value(const char* str, size_t length);
+  void number(int64_t value);
+  // non-finite values are written as null
+  void real(double value);
+  void boolean(bool value);
+
+  // string value composed of several parts
+  void beginString();
+  void appendString(const std::string& str) { writeEscaped(str.data(), str.size()); }
+  void appendString(const char* str, size_t length) { writeEscaped(str, length); }
+  void appendNumber(int64_t value);
+  void endString() { put('"'); }
+private:
+  void separate();
+  void beginContainer(char c);
+  void endContainer(char c);
+  void put(char c) {
+    if(pos == buffer.size())
+      flush();
+    buffer[pos++] = c;
+  }
+  void write(const char* data, size_t length);
+  void writeEscaped(const char* str, size_t length);
+  void flush();
+
+  std::vector<char> buffer;
+  size_t pos = 0;
+  FILE* file = nullptr;
+  std::string* target = nullptr;
+  bool ownsFile = false;
+  bool failed = false;
+  uint64_t written = 0;
+  // per open container: true while it has no entries
+  std::vector<bool> empty;
+  bool afterKey = false;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_JSONWRITER_H_ */
@@ -0,0 +1,16 @@
+#ifndef WHATSUPDOC_LOCATION_H_
+#define WHATSUPDOC_LOCATION_H_
+
+#include <string>
+
+namespace WhatsUpDoc {
+
+struct Location {
+  std::string file;
+  unsigned int line;
+  unsigned int col;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_LOCATION_H_ */
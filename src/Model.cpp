@@ -0,0 +1,124 @@
+#include "Model.h"
+#include "ParsingContext.h"
+#include "JsonWriter.h"
+#include "JsonExport.h"
+
+namespace WhatsUpDoc {
+
+// -------------------------------------------------
+
+const std::string& MemberView::getName() const { return member->name; }
+const Location& MemberView::getLocation() const { return member->location; }
+const std::string& MemberView::getDescription() const { return member->description; }
+const std::string& MemberView::getCppRef() const { return member->cppRef; }
+const std::string& MemberView::getMemberGroup() const { return member->group; }
+int MemberView::getMinParams() const { return member->minParams; }
+int MemberView::getMaxParams() const { return member->maxParams; }
+bool MemberView::isDeprecated() const { return member->deprecated; }
+
+MemberView::Kind MemberView::getKind() const {
+  switch(member->kind) {
+    case Member::FUNCTION: return FUNCTION;
+    case Member::CONST: return CONSTANT;
+    default: return UNKNOWN;
+  }
+}
+
+CompoundView MemberView::getCompound() const {
+  return CompoundView(&findCompound(member->compound, context), context);
+}
+
+// -------------------------------------------------
+
+const std::string& ReferenceView::getName() const { return ref->name; }
+const Location& ReferenceView::getLocation() const { return ref->location; }
+
+CompoundView ReferenceView::getCompound() const {
+  return CompoundView(&findCompound(ref->compound, context), context);
+}
+
+CompoundView ReferenceView::getTarget() const {
+  return CompoundView(&findCompound(ref->ref, context), context);
+}
+
+// -------------------------------------------------
+
+bool CompoundView::isNull() const { return cmp->isNull() || cmp->name.empty(); }
+const std::string& CompoundView::getId() const { return toString(cmp->id); }
+const std::string& CompoundView::getName() const { return cmp->name; }
+const std::string& CompoundView::getFullname() const { return cmp->fullname; }
+const std::string& CompoundView::getDescription() const { return cmp->decription; }
+const Location& CompoundView::getLocation() const { return cmp->location; }
+
+CompoundView::Kind CompoundView::getKind() const {
+  switch(cmp->kind) {
+    case Compound::NAMESPACE: return NAMESPACE;
+    case Compound::TYPE: return TYPE;
+    case Compound::GROUP: return GROUP;
+    default: return UNKNOWN;
+  }
+}
+
+CompoundView CompoundView::getParent() const {
+  return CompoundView(&findCompound(cmp->parentId, context), context);
+}
+
+CompoundView CompoundView::getGroup() const {
+  return CompoundView(&findCompound(cmp->group, context), context);
+}
+
+CompoundView CompoundView::getBase() const {
+  return CompoundView(&findCompound(cmp->base, context), context);
+}
+
+std::vector<MemberView> CompoundView::getMembers() const {
+  std::vector<MemberView> result;
+  result.reserve(cmp->member.size());
+  for(auto h : cmp->member)
+    result.emplace_back(&context->members[h], context);
+  return result;
+}
+
+std::vector<ReferenceView> CompoundView::getChildren() const {
+  std::vector<ReferenceView> result;
+  result.reserve(cmp->children.size());
+  for(auto h : cmp->children)
+    result.emplace_back(&context->references[h], context);
+  return result;
+}
+
+std::string CompoundView::toJSON() const {
+  std::string document;
+  JsonWriter writer(4*1024);
+  writer.open(document);
+  writeCompoundJSON(writer, *cmp, context);
+  writer.close();
+  return document;
+}
+
+// -------------------------------------------------
+
+Model::Model(const ParsingContext* context) : context(context) {
+  auto& store = context->compounds;
+  for(CompoundStore::Index i=0; i<store.size(); ++i) {
+    auto& cmp = store[i];
+    // merged compounds are resolved once, the lookup does not add strings to the StringId table
+    ids.emplace(toString(store.getId(i)), &findCompound(store.getId(i), context));
+    if(cmp.isRef() || cmp.name.empty())
+      continue;
+    fullnames.emplace(cmp.fullname, compounds.size());
+    compounds.emplace_back(&cmp, context);
+  }
+}
+
+CompoundView Model::findById(const std::string& id) const {
+  auto it = ids.find(id);
+  return CompoundView(it != ids.end() ? it->second : &findCompound(EScript::StringId(), context), context);
+}
+
+CompoundView Model::findByFullname(const std::string& fullname) const {
+  auto it = fullnames.find(fullname);
+  return it != fullnames.end() ? compounds[it->second] : CompoundView(&findCompound(EScript::StringId(), context), context);
+}
+
+} /* WhatsUpDoc */
@@ -0,0 +1,102 @@
+#ifndef WHATSUPDOC_MODEL_H_
+#define WHATSUPDOC_MODEL_H_
+
+#include "Location.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace WhatsUpDoc {
+struct ParsingContext;
+struct Compound;
+struct Member;
+struct Reference;
+class CompoundView;
+
+/**
+ * Read-only access to the resolved model of a Parser (see Parser::getModel()).
+ * All views stay valid until the parser parses or updates files or is destroyed.
+ */
+class MemberView {
+public:
+  enum Kind { UNKNOWN, FUNCTION, CONSTANT };
+
+  MemberView(const Member* member, const ParsingContext* context) : member(member), context(context) {}
+  const std::string& getName() const;
+  Kind getKind() const;
+  // compound declaring the member
+  CompoundView getCompound() const;
+  const Location& getLocation() const;
+  const std::string& getDescription() const;
+  const std::string& getCppRef() const;
+  // member group (@name) within the compound
+  const std::string& getMemberGroup() const;
+  int getMinParams() const;
+  int getMaxParams() const;
+  bool isDeprecated() const;
+private:
+  const Member* member;
+  const ParsingContext* context;
+};
+
+// nested namespace or type declared in a compound
+class ReferenceView {
+public:
+  ReferenceView(const Reference* ref, const ParsingContext* context) : ref(ref), context(context) {}
+  const std::string& getName() const;
+  // compound declaring the reference
+  CompoundView getCompound() const;
+  const Location& getLocation() const;
+  // referenced namespace or type
+  CompoundView getTarget() const;
+private:
+  const Reference* ref;
+  const ParsingContext* context;
+};
+
+class CompoundView {
+public:
+  enum Kind { UNKNOWN, NAMESPACE, TYPE, GROUP };
+
+  CompoundView(const Compound* cmp, const ParsingContext* context) : cmp(cmp), context(context) {}
+  // true if the compound does not exist or is unnamed
+  bool isNull() const;
+  const std::string& getId() const;
+  const std::string& getName() const;
+  const std::string& getFullname() const;
+  const std::string& getDescription() const;
+  const Location& getLocation() const;
+  Kind getKind() const;
+  CompoundView getParent() const;
+  CompoundView getGroup() const;
+  CompoundView getBase() const;
+  // groups contain the members & references of other compounds
+  std::vector<MemberView> getMembers() const;
+  std::vector<ReferenceView> getChildren() const;
+  // document as written by Parser::writeJSON
+  std::string toJSON() const;
+private:
+  const Compound* cmp;
+  const ParsingContext* context;
+};
+
+class Model {
+public:
+  explicit Model(const ParsingContext* context);
+  // named namespaces, types & groups in declaration order
+  const std::vector<CompoundView>& getCompounds() const { return compounds; }
+  // compound by id (merged compounds are resolved) or by full name, a null view if there is none
+  CompoundView findById(const std::string& id) const;
+  CompoundView findByFullname(const std::string& fullname) const;
+private:
+  const ParsingContext* context;
+  std::vector<CompoundView> compounds;
+  std::unordered_map<std::string, size_t> fullnames;
+  // id (also of merged compounds) -> resolved compound
+  std::unordered_map<std::string, const Compound*> ids;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_MODEL_H_ */
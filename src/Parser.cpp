@@ -1,109 +1,44 @@
 #include "Parser.h"
 #include "Helper.h"
 #include "CommentParser.h"
+#include "ParsingContext.h"
+#include "ResultCache.h"
+#include "Serialization.h"
+#include "TokenIndex.h"
+#include "AstIndex.h"
+#include "JsonWriter.h"
+#include "JsonExport.h"
+#include "Bundle.h"
+#include "Statistics.h"
+#include "Trace.h"
 
 #include <clang-c/Index.h>
+#include <clang-c/CXCompilationDatabase.h>
 
 #include <EScript/Utils/StringId.h>
 #include <EScript/Utils/StringUtils.h>
 #include <EScript/Utils/IO/IO.h>
 
 #include <iostream>
+#include <fstream>
 #include <sstream>
+#include <cstring>
+#include <cstdio>
 #include <unordered_map>
-#include <deque>
+#include <unordered_set>
 #include <algorithm>
-
-//#define DEBUG 2
-
-#if DEBUG >= 1
-#define DEBUG1(s) std::cout << s << std::endl;
-#else
-#define DEBUG1(s)
-#endif
-
-#if DEBUG >= 2
-#define DEBUG2(s) std::cout << s << std::endl;
-#else
-#define DEBUG2(s)
-#endif
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 namespace WhatsUpDoc {
 using namespace EScript;
 
-struct Member {
-  std::string name;
-  enum {UNKNOWN, FUNCTION, CONST} kind = UNKNOWN;
-  StringId compound;
-  Location location;
-  std::string description;
-  std::string cppRef;
-  std::string group;
-  int minParams = 0;
-  int maxParams = 0;
-  bool deprecated = false;
-};
-
-struct Reference {
-  std::string name;
-  StringId compound;
-  Location location;
-  StringId ref;
-};
-
-struct InitCall {
-  StringId id;
-  StringId lib;
-  StringId group;
-};
-
-struct Compound {
-  StringId id;
-  StringId refId;
-  StringId parentId;
-  StringId group;
-  StringId base;
-  std::string name;
-  std::string fullname;
-  std::string decription;
-  Location location;
-  enum {UNKNOWN, NAMESPACE, TYPE, GROUP} kind = UNKNOWN;
-  std::vector<Member> member;
-  std::vector<Reference> children;
-  bool isNull() const { return id.empty(); }
-  bool isRef() const { return !refId.empty(); }
-};
-
-struct InitFunction {
-  StringId id;
-  StringId paramId;
-  StringId group;
-  Location location;
-};
-
-struct ParsingContext {
-  CXIndex index;
-  CXTranslationUnit tu;
-  InitFunction activeInit;
-  StringId activeGroup;
-  bool groupBlock = false;
-  StringId activeMemberGroup;
-  bool memberGroupBlock = false;
-  bool deprecated = false; 
-  //std::unordered_map<StringId, InitFunction> inits;
-  std::unordered_map<StringId, std::string> names;
-  std::deque<CommentTokenPtr> comments;
-  std::unordered_map<StringId, Compound> compounds;
-  std::unordered_map<StringId, InitCall> initCalls;
-};
-
 // -------------------------------------------------
 
-void mergeCompounds(Compound& c1, Compound& c2, ParsingContext* context) {
-  DEBUG1("  merge " << c1.id << " & " << c2.id)
-  if(c1.id == c2.id) return;
-  c2.refId = c1.id;
-  
+// fragments skip empty descriptions, otherwise the descriptions depend on how the files were split
+void mergeCompoundData(Compound& c1, Compound& c2, ParsingContext* context, bool fragment=false) {
   if(c1.name.empty())
     c1.name = c2.name;
   c2.name.clear();
@@ -117,7 +52,7 @@ void mergeCompounds(Compound& c1, Compound& c2, ParsingContext* context) {
   
   if(c1.decription.empty())
     c1.decription = c2.decription;
-  else
+  else if(!fragment || !c2.decription.empty())
     c1.decription.append("<br/>" + c2.decription);
   c2.decription.clear();
     
@@ -130,59 +65,83 @@ void mergeCompounds(Compound& c1, Compound& c2, ParsingContext* context) {
   if(c1.location.file.empty())
     c1.location = c2.location;
       
-  for(auto& v : c2.member)
-    v.compound = c1.id;
-  std::move(c2.member.begin(), c2.member.end(), std::back_inserter(c1.member));
+  // entries of groups are owned by other compounds and keep their owner
+  for(auto h : c2.member) {
+    auto& v = context->members[h];
+    if(v.compound == c2.id)
+      v.compound = c1.id;
+  }
+  c1.member.insert(c1.member.end(), c2.member.begin(), c2.member.end());
   c2.member.clear();
   
-  for(auto& v : c2.children) {
+  for(auto h : c2.children) {
+    auto& v = context->references[h];
+    if(v.compound != c2.id)
+      continue;
     v.compound = c1.id;
-    auto& c = context->compounds[v.ref];
-    c.parentId = c1.id;
+    // the child might not be merged yet, its entry is reserved to keep the parent
+    context->compounds.at(v.ref).parentId = c1.id;
   }
-  std::move(c2.children.begin(), c2.children.end(), std::back_inserter(c1.children));
+  c1.children.insert(c1.children.end(), c2.children.begin(), c2.children.end());
   c2.children.clear();
 }
 
+void mergeCompounds(Compound& c1, Compound& c2, ParsingContext* context, bool fragment=false) {
+  if(c1.id == c2.id) return;
+  context->compounds.setAlias(c2.id, c1.id);
+  mergeCompoundData(c1, c2, context, fragment);
+}
+
 // -------------------------------------------------
 
 void extractComments(CXCursor cursor, ParsingContext* context) {
-  CXSourceRange range = clang_getCursorExtent(cursor);
-  CXTranslationUnit tu = clang_Cursor_getTranslationUnit(cursor);
-  CXToken *tokens = 0;
-  unsigned int nTokens = 0;
-  clang_tokenize(tu, range, &tokens, &nTokens);
-  for (unsigned int i = 0; i < nTokens; i++) {
-    CXTokenKind kind = clang_getTokenKind(tokens[i]);
-    if(kind == CXToken_Comment) {
-      auto location = getTokenLocation(tu, tokens[i]);
-      std::string comment = toString(clang_getTokenSpelling(tu, tokens[i]));
-      std::string pre = comment.substr(0, 3);
-      if(pre == "///" || pre == "//!" || pre == "/**" || pre == "/*!") {
-        auto comments = parseComment(comment, location);
-        // merge consecutive comment blocks
-        if(!context->comments.empty() && !comments.empty() && 
-              context->comments.back()->getType() == CommentTokens::TCommentEnd::TYPE && 
-              context->comments.back()->line == comments.front()->line)
-          context->comments.pop_back();
-        std::move(comments.begin(), comments.end(), back_inserter(context->comments));
+  Stopwatch watch;
+  auto range = context->tokens->getTokens(cursor);
+  for(auto& token : range) {
+    if(token.kind == CXToken_Comment && token.length >= 3) {
+      const char* comment = token.spelling;
+      if(std::strncmp(comment, "///", 3) == 0 || std::strncmp(comment, "//!", 3) == 0 || 
+          std::strncmp(comment, "/**", 3) == 0 || std::strncmp(comment, "/*!", 3) == 0) {
+        TraceSpan span("parseComment");
+        parseComment(comment, token.length, context->tokens->getLocation(range.file, token), context->comments);
       }
     }
   }
-  clang_disposeTokens(tu, tokens, nTokens);
+  if(context->stats)
+    context->stats->comments += watch.getWallTime();
+}
+
+// -------------------------------------------------
+
+MemberHandle addMember(Member&& member, ParsingContext* context) {
+  context->members.emplace_back(std::move(member));
+  return static_cast<MemberHandle>(context->members.size()-1);
+}
+
+ReferenceHandle addReference(Reference&& ref, ParsingContext* context) {
+  context->references.emplace_back(std::move(ref));
+  return static_cast<ReferenceHandle>(context->references.size()-1);
 }
 
 // -------------------------------------------------
 
+// returns the compound for the id (or the one it was merged into), an empty compound is added if necessary
 Compound& getCompound(const StringId& id, ParsingContext* context) {
   static Compound nullCompound;
   if(id.empty())
     return nullCompound;
-  auto* cmp = &context->compounds[id];
-  while(cmp->isRef()) {
-    cmp = &context->compounds[cmp->refId];
-  }
-  return *cmp;
+  auto& compounds = context->compounds;
+  return compounds[compounds.resolve(compounds.insert(id))];
+}
+
+// same as getCompound without adding compounds
+const Compound& findCompound(const StringId& id, const ParsingContext* context) {
+  static const Compound nullCompound{};
+  auto& compounds = context->compounds;
+  auto index = id.empty() ? CompoundStore::NONE : compounds.find(id);
+  if(index == CompoundStore::NONE)
+    return nullCompound;
+  return compounds[compounds.resolve(index)];
 }
 
 // -------------------------------------------------
@@ -191,23 +150,19 @@ Compound& resolveCompound(CXCursor cursor, ParsingContext* context) {
   static Compound nullCompound;
   if(clang_Cursor_isNull(cursor))
     return nullCompound;
-  cursor = findExposed(cursor);
+  TraceSpan span("resolveCompound");
+  cursor = context->ast->findExposed(cursor);
   auto kind = clang_getCursorKind(cursor);
   
-  DEBUG2("  resolve " << cursor)
-  
-  if(!hasType(cursor, "EScript::Type") && !hasType(cursor, "EScript::Namespace"))
+  auto typeClass = context->ast->getTypeClass(cursor);
+  if(typeClass != AstIndex::TYPE && typeClass != AstIndex::NAMESPACE)
     return nullCompound;
   
-  DEBUG2("    cursor " << cursor)
-  
-  
   if(kind == CXCursor_CallExpr) {
-    CXCursor ref = findTypeRef(cursor, "EScript::Type");
+    CXCursor ref = context->ast->findTypeRef(cursor, AstIndex::TYPE);
     if(!clang_Cursor_isNull(ref)) {
       cursor = ref;
       kind = clang_getCursorKind(cursor);
-      DEBUG2("    ref " << cursor)
     }
   }
   
@@ -216,28 +171,26 @@ Compound& resolveCompound(CXCursor cursor, ParsingContext* context) {
     if(!clang_Cursor_isNull(ref)) {
       cursor = ref;
       kind = clang_getCursorKind(cursor);
-      DEBUG2("    ref " << cursor)
     }
   }
   
   if(kind == CXCursor_VarDecl) {
     // search for a getTypeObject call or new Type
-    auto newType = findCursor(cursor, "", CXCursor_CXXNewExpr, "EScript::Type");
+    auto newType = context->ast->findCursor(cursor, "", CXCursor_CXXNewExpr, AstIndex::TYPE);
     if(clang_Cursor_isNull(newType)) {
-      CXCursor ref = getCursorRef(cursor);
+      CXCursor ref = context->ast->getCursorRef(cursor);
       if(!clang_Cursor_isNull(ref)) {
         cursor = ref;
         kind = clang_getCursorKind(cursor);
-        DEBUG2("    ref " << cursor)
       }
     }
   }
-  StringId id = toString(clang_getCursorUSR(cursor));
+  StringId id = getCursorId(cursor);
   Location location = getCursorLocation(cursor);
   if(id.empty()) {
-    CXCursor ref = getCursorRef(cursor);
+    CXCursor ref = context->ast->getCursorRef(cursor);
     if(!clang_Cursor_isNull(ref)) {
-      id = toString(clang_getCursorUSR(ref));
+      id = getCursorId(ref);
       location = getCursorLocation(ref);
     }
   }
@@ -245,25 +198,24 @@ Compound& resolveCompound(CXCursor cursor, ParsingContext* context) {
     id = context->activeInit.id;
   if(id.empty())
     return nullCompound;
-  DEBUG2("    id " << id)
+  if(span.isActive())
+    span.setDetail(toString(id));
   
   auto& cmp = getCompound(id, context);
   if(cmp.isNull()) {
     cmp.id = id;    
-    DEBUG2("    new " << cmp.id)
     cmp.location = location;
-    if(hasType(cursor, "EScript::Namespace"))
+    typeClass = context->ast->getTypeClass(cursor);
+    if(typeClass == AstIndex::NAMESPACE)
       cmp.kind = Compound::NAMESPACE; 
-    else if(hasType(cursor, "EScript::Type")) {
+    else if(typeClass == AstIndex::TYPE) {
       cmp.kind = Compound::TYPE;
     }
   }
-  DEBUG2("    resolved " << cmp.id)
   if(cmp.base.empty() && cmp.kind == Compound::TYPE) {
     // try to find base type
-    auto newType = findCursor(cursor, "", CXCursor_CXXNewExpr, "EScript::Type", false);
+    auto newType = context->ast->findCursor(cursor, "", CXCursor_CXXNewExpr, AstIndex::TYPE, false);
     if(!clang_Cursor_isNull(newType)) {
-      DEBUG2("  resolve base")
       auto baseCmp = resolveCompound(newType, context);
       if(!baseCmp.isNull())
         cmp.base = baseCmp.id;
@@ -275,7 +227,6 @@ Compound& resolveCompound(CXCursor cursor, ParsingContext* context) {
 // -------------------------------------------------
 
 std::string resolveComments(const Location& location, ParsingContext* context) {
-  using namespace CommentTokens;
   std::string result;
   Location cloc{location.file,0,0};
   bool descriptionMode = false;
@@ -287,15 +238,15 @@ std::string resolveComments(const Location& location, ParsingContext* context) {
   context->deprecated = false;
   StringId defGrp;
   
-  while(!context->comments.empty() && context->comments.front()->line <= location.line) {
-    auto& token = context->comments.front();
-    cloc.line = token->line;
-    switch(token->getType()) {
-      case TDefGroup::TYPE: {
-        auto t = token->to<TDefGroup>();
-        auto& grp = context->compounds[t->id];
-        grp.id = t->id;
-        grp.name = t->name;
+  auto& comments = context->comments;
+  while(!comments.empty() && comments.front().line <= location.line) {
+    auto& token = comments.front();
+    cloc.line = token.line;
+    switch(token.tag) {
+      case CommentToken::DEF_GROUP: {
+        auto& grp = context->compounds.at(toStringId(comments.getText(token)));
+        grp.id = toStringId(comments.getText(token));
+        grp.name = comments.getName(token);
         grp.kind = Compound::GROUP;
         grp.location = cloc;
         //context->activeGroup = grp.id;
@@ -303,20 +254,18 @@ std::string resolveComments(const Location& location, ParsingContext* context) {
         descriptionMode = true;
         break;
       }
-      case TInGroup::TYPE: {
-        auto t = token->to<TInGroup>();
-        auto& grp = context->compounds[t->id];
+      case CommentToken::IN_GROUP: {
+        auto& grp = context->compounds.at(toStringId(comments.getText(token)));
         defGrp = StringId();
-        grp.id = t->id;
+        grp.id = toStringId(comments.getText(token));
         context->activeGroup = grp.id;
         break;
       }
-      case TMemberGroup::TYPE: {
-        auto t = token->to<TMemberGroup>();
-        context->activeMemberGroup = t->id;
+      case CommentToken::MEMBER_GROUP: {
+        context->activeMemberGroup = toStringId(comments.getText(token));
         break;
       }
-      case TBlockStart::TYPE: {
+      case CommentToken::BLOCK_START: {
         descriptionMode = false;
         if(!context->activeMemberGroup.empty()) {
           context->memberGroupBlock = true;
@@ -330,7 +279,7 @@ std::string resolveComments(const Location& location, ParsingContext* context) {
         }
         break;
       }
-      case TBlockEnd::TYPE: {
+      case CommentToken::BLOCK_END: {
         descriptionMode = false;
         if(!context->activeMemberGroup.empty()) {
           context->memberGroupBlock = false;
@@ -343,56 +292,52 @@ std::string resolveComments(const Location& location, ParsingContext* context) {
         }
         break;
       }
-      case TCommentEnd::TYPE: {
+      case CommentToken::COMMENT_END: {
         defGrp = StringId();
         descriptionMode = false;
         break;
       }
-      case TTextLine::TYPE: {
-        auto t = token->to<TTextLine>();
+      case CommentToken::TEXT_LINE: {
         if(descriptionMode && !defGrp.empty()) {
-          auto& grp = context->compounds[defGrp];
+          auto& grp = context->compounds.at(defGrp);
           if(!grp.decription.empty()) grp.decription += "<br/>";
-          grp.decription += t->text;
+          comments.appendEscaped(token, grp.decription);
         } else {
           if(!result.empty()) result += "<br/>";
-          result += t->text;
+          comments.appendEscaped(token, result);
         }
         break;
       }
-      case TDeprecated::TYPE: {
-        auto t = token->to<TDeprecated>();
+      case CommentToken::DEPRECATED: {
         context->deprecated = true;
         if(!result.empty()) result += "<br/>";
-        if(t->description.empty())
+        if(token.length == 0)
           result += "**Deprecated**";
         else
-          result += "**Deprecated:** " + t->description;
+          result += "**Deprecated:** " + comments.getText(token);
         break;
       }
-      case TCodeBlockStart::TYPE: {
+      case CommentToken::CODE_BLOCK_START: {
         descriptionMode = false;
-        auto t = token->to<TCodeBlockStart>();
-        std::string lang = t->lang;
+        std::string lang = comments.getText(token);
         std::transform(lang.begin(), lang.end(), lang.begin(), ::tolower);
         if(lang.compare("escript") == 0)
           lang = "js";
         result += "\n```" + lang;
         break;
       }
-      case TCodeBlockEnd::TYPE: {
+      case CommentToken::CODE_BLOCK_END: {
         descriptionMode = false;
         result += "\n```\n";
         break;
       }
-      case TCodeLine::TYPE: {
+      case CommentToken::CODE_LINE: {
         descriptionMode = false;
-        auto t = token->to<TCodeLine>();
-        result += "\n" + t->text;
+        result += "\n" + comments.getText(token);
         break;
       }
     }
-    context->comments.pop_front();
+    comments.popFront();
   }
   return result;
 }
@@ -400,6 +345,7 @@ std::string resolveComments(const Location& location, ParsingContext* context) {
 // -------------------------------------------------
 
 void handleDeclareFunction(CXCursor cursor, ParsingContext* context) {
+  TraceSpan span("handleDeclareFunction");
   int argc = clang_Cursor_getNumArguments(cursor);
   auto location = getCursorLocation(cursor);
   Member fun;
@@ -411,105 +357,107 @@ void handleDeclareFunction(CXCursor cursor, ParsingContext* context) {
     return;
   }
   
-  fun.name = extractStringLiteral(clang_Cursor_getArgument(cursor, 1));
-  DEBUG1("declare function " << fun.name << " @ " << location)
+  fun.name = extractStringLiteral(clang_Cursor_getArgument(cursor, 1), *context->tokens);
+  span.setDetail(fun.name);
   
   CXCursor libArg = clang_Cursor_getArgument(cursor, 0);
-  DEBUG2("  resolve lib")
   auto& cmp = resolveCompound(libArg, context);
   if(cmp.isNull()) {
     std::cerr << std::endl << "invalid function declaration at " << location << "." << std::endl;
     return;
   }
   
-  DEBUG1("  compound " << cmp.id)
   fun.compound = cmp.id;
   fun.kind = Member::FUNCTION;
   if(argc == 5) {
-    fun.minParams = extractIntLiteral(clang_Cursor_getArgument(cursor, 2));
-    fun.maxParams = extractIntLiteral(clang_Cursor_getArgument(cursor, 3));
+    fun.minParams = extractIntLiteral(clang_Cursor_getArgument(cursor, 2), *context->tokens);
+    fun.maxParams = extractIntLiteral(clang_Cursor_getArgument(cursor, 3), *context->tokens);
   }
   if(!context->activeMemberGroup.empty())
-    fun.group = context->activeMemberGroup.toString();
+    fun.group = toString(context->activeMemberGroup);
   fun.deprecated = context->deprecated;
   
   // try to find corresponding c++ function
-  CXCursor fnArg = getCursorRef(clang_Cursor_getArgument(cursor, argc == 5 ? 4 : 2));
-  CXCursor fnRef = findRef(fnArg, fun.name);
+  CXCursor fnArg = context->ast->getCursorRef(clang_Cursor_getArgument(cursor, argc == 5 ? 4 : 2));
+  CXCursor fnRef = context->ast->findRef(fnArg, fun.name);
   if(!clang_Cursor_isNull(fnRef))
     fun.cppRef = getFullyQualifiedName(fnRef);
-  StringId grpId;
-  
-  StringId libId = toString(clang_getCursorUSR(getCursorRef(libArg)));
-  if(!context->activeGroup.empty()) {
-    grpId = context->activeGroup;
-  } else if(libId == context->activeInit.paramId) {
-    grpId = context->activeInit.group;
-  }
+  StringId grpId = context->activeGroup;
+  StringId libId = getCursorId(context->ast->getCursorRef(libArg));
   
+  auto handle = addMember(std::move(fun), context);
   if(!grpId.empty()) {
-    auto& grp = context->compounds[grpId];
-    grp.member.emplace_back(fun);
+    auto& grp = context->compounds.at(grpId);
+    grp.member.emplace_back(handle);
+  } else if(libId == context->activeInit.paramId) {
+    PendingGroupEntry entry;
+    entry.init = context->activeInit.id;
+    entry.handle = handle;
+    context->pendingGroups.emplace_back(std::move(entry));
   }
-  cmp.member.emplace_back(std::move(fun));
+  cmp.member.emplace_back(handle);
 }
 
 // -------------------------------------------------
 
 void handleDeclareConstant(CXCursor cursor, ParsingContext* context) {
+  TraceSpan span("handleDeclareConstant");
   int argc = clang_Cursor_getNumArguments(cursor);
   auto location = getCursorLocation(cursor);
   if(argc != 3) return;
   std::string comment = resolveComments(location, context);
   
   std::string name;
-  CXCursor nameRef = getCursorRef(clang_Cursor_getArgument(cursor, 1));
+  CXCursor nameRef = context->ast->getCursorRef(clang_Cursor_getArgument(cursor, 1));
   if(!clang_Cursor_isNull(nameRef)) {
-    StringId refId = toString(clang_getCursorUSR(nameRef));
+    StringId refId = getCursorId(nameRef);
     auto nameIt = context->names.find(refId);
-    if(nameIt != context->names.end())
+    if(nameIt != context->names.end()) {
       name = nameIt->second;
+    } else {
+      // the declaring header might have been visited by another translation unit
+      CXCursor def = clang_getCursorDefinition(nameRef);
+      if(!clang_Cursor_isNull(def) && toString(clang_getCursorSpelling(def)) == "getClassName")
+        name = extractStringLiteral(def, *context->tokens);
+    }
   } else {
-    name = extractStringLiteral(clang_Cursor_getArgument(cursor, 1));
+    name = extractStringLiteral(clang_Cursor_getArgument(cursor, 1), *context->tokens);
   }
   if(name.empty()) {
     std::cerr << std::endl << "could not resolve constant name at " << location << "." << std::endl;
     return;
   }
-  DEBUG1("declare constant " << name << " @ " << location)
+  span.setDetail(name);
   
   CXCursor libArg = clang_Cursor_getArgument(cursor, 0);
-  DEBUG2("  resolve lib ")
   auto& cmp = resolveCompound(libArg, context);
   if(cmp.isNull()) {
     std::cerr << std::endl << "invalid constant declaration at " << location << "." << std::endl;
     return;
   }
-  StringId grpId;
-  StringId libId = toString(clang_getCursorUSR(getCursorRef(libArg)));
-  if(!context->activeGroup.empty()) {
-    grpId = context->activeGroup;
-  } else if(libId == context->activeInit.paramId) {
-    grpId = context->activeInit.group;
-  }
+  StringId grpId = context->activeGroup;
+  StringId libId = getCursorId(context->ast->getCursorRef(libArg));
   
-  DEBUG2("  resolve value ")
   auto& cmpRef = resolveCompound(clang_Cursor_getArgument(cursor, 2), context);
-  DEBUG1("  compound " << cmp.id)
   if(!cmpRef.isNull()) {
     cmpRef.name = name;
     if(cmpRef.id == cmp.id)
       return;
-    DEBUG1("  ref " << cmpRef.id)
     cmpRef.parentId = cmp.id;
     cmpRef.group = grpId;
     cmpRef.decription = comment;
-    Reference attr{name, cmp.id, location, cmpRef.id};
+    auto handle = addReference(Reference{name, cmp.id, location, cmpRef.id}, context);
     if(!cmpRef.group.empty()) {
-      auto& grp = context->compounds[cmpRef.group];
-      grp.children.emplace_back(attr);
+      auto& grp = context->compounds.at(cmpRef.group);
+      grp.children.emplace_back(handle);
+    } else if(libId == context->activeInit.paramId) {
+      PendingGroupEntry entry;
+      entry.init = context->activeInit.id;
+      entry.kind = PendingGroupEntry::CHILD;
+      entry.handle = handle;
+      context->pendingGroups.emplace_back(std::move(entry));
     }
-    cmp.children.emplace_back(std::move(attr));
+    cmp.children.emplace_back(handle);
   } else {
     Member attr;
     attr.name = name;
@@ -519,33 +467,37 @@ void handleDeclareConstant(CXCursor cursor, ParsingContext* context) {
     attr.description = comment;
     attr.deprecated = context->deprecated;
     if(!context->activeMemberGroup.empty())
-      attr.group = context->activeMemberGroup.toString();
+      attr.group = toString(context->activeMemberGroup);
     
     // try to find corresponding c++ object
-    CXCursor objRef = findRef(clang_Cursor_getArgument(cursor, 2), name);
+    CXCursor objRef = context->ast->findRef(clang_Cursor_getArgument(cursor, 2), name);
     if(!clang_Cursor_isNull(objRef))
       attr.cppRef = getFullyQualifiedName(objRef);
     
+    auto handle = addMember(std::move(attr), context);
     if(!grpId.empty()) {
-      auto& grp = context->compounds[grpId];
-      grp.member.emplace_back(attr);
-    } 
-    cmp.member.emplace_back(std::move(attr));
+      auto& grp = context->compounds.at(grpId);
+      grp.member.emplace_back(handle);
+    } else if(libId == context->activeInit.paramId) {
+      PendingGroupEntry entry;
+      entry.init = context->activeInit.id;
+      entry.handle = handle;
+      context->pendingGroups.emplace_back(std::move(entry));
+    }
+    cmp.member.emplace_back(handle);
   }
 }
 
 // -------------------------------------------------
 
 void handleInitCall(CXCursor cursor, ParsingContext* context) {
+  TraceSpan span("handleInitCall");
   int argc = clang_Cursor_getNumArguments(cursor);
   if(argc != 1) return;
   auto location = getCursorLocation(cursor);
-  DEBUG1("init call @ " << location)
-  DEBUG2("  resolve lib ")
   auto& cmp = resolveCompound(clang_Cursor_getArgument(cursor, 0), context);
-  DEBUG2("  resolve call ")
   CXCursor callRef = clang_getCursorReferenced(cursor);
-  StringId callId = toString(clang_getCursorUSR(callRef));
+  StringId callId = getCursorId(callRef);
   auto& initCmp = getCompound(callId, context);
   if(cmp.isNull() || callId.empty()) {
     std::cerr << std::endl << "invalid init call at " << location << "." << std::endl;
@@ -553,57 +505,278 @@ void handleInitCall(CXCursor cursor, ParsingContext* context) {
   }
   if(initCmp.id.empty())
     initCmp.id = callId;
+  // the call is only recorded, the compounds are merged & the groups inherited by resolveInitCalls
   InitCall call;
   call.id = callId;
   call.lib = cmp.id;
   resolveComments(location, context);
-  if(!context->activeGroup.empty()) {
-    call.group = context->activeGroup;
-    auto& grp = context->compounds[context->activeGroup];
-    for(auto& ref : initCmp.children) {
-      auto& c = context->compounds[ref.ref];
-      if(c.group.empty()) {
-        c.group = context->activeGroup;
-        grp.children.push_back(ref);
+  call.group = context->activeGroup;
+  context->initCalls[call.id] = std::move(call);
+}
+
+// -------------------------------------------------
+
+void visitInitFunction(CXCursor cursor, ParsingContext* context) {
+  auto* ast = context->ast;
+  FileStats unused;
+  auto& stats = context->stats ? *context->stats : unused;
+  // handlers may add nodes to the index, the guard keeps index, end & next valid
+  AstIndex::Guard guard(*ast);
+  uint32_t index = ast->getIndex(cursor);
+  uint32_t end = ast->getNode(index).end;
+  for(uint32_t i = index+1; i < end;) {
+    CXCursor child = ast->getNode(i).cursor;
+    CXCursorKind kind = ast->getNode(i).kind;
+    uint32_t next = ast->getNode(i).end;
+    if(kind == CXCursor_FunctionDecl) {
+      i = next;
+    } else if(kind == CXCursor_CallExpr) {
+      auto name = ast->getSpelling(i);
+      if(name == "declareFunction") {
+        handleDeclareFunction(child, context);
+        ++stats.functions;
+      } else if(name == "declareConstant") {
+        handleDeclareConstant(child, context);
+        ++stats.constants;
+      } else if(name == "init") {
+        handleInitCall(child, context);
+        ++stats.initCalls;
       }
+      i = next;
+    } else {
+      ++i;
     }
   }
-  mergeCompounds(cmp, initCmp, context);
-  context->initCalls[call.id] = std::move(call);
 }
 
 // -------------------------------------------------
 
-CXChildVisitResult visitInitFunction(CXCursor cursor, CXCursor parent, CXClientData data) {
-  auto context = reinterpret_cast<ParsingContext*>(data);
-  CXCursorKind kind = clang_getCursorKind(cursor);
-  if(kind == CXCursor_FunctionDecl) {
-    return CXChildVisit_Continue;
-  } else if(kind == CXCursor_CallExpr) {
-    auto name = toString(clang_getCursorSpelling(cursor));
-    if(name == "declareFunction") {
-      handleDeclareFunction(cursor, context);
-    } else if(name == "declareConstant") {
-      handleDeclareConstant(cursor, context);
-    } else if(name == "init") {
-      handleInitCall(cursor, context);
+bool SourceScope::contains(const std::string& path) const {
+  for(auto& prefix : exclude) {
+    if(hasPathPrefix(path, prefix))
+      return false;
+  }
+  if(include.empty())
+    return true;
+  for(auto& prefix : include) {
+    if(hasPathPrefix(path, prefix))
+      return true;
+  }
+  return false;
+}
+
+// -------------------------------------------------
+
+void CompoundStore::clear() {
+  compounds.clear();
+  ids.clear();
+  parents.clear();
+  indices.clear();
+}
+
+CompoundStore::Index CompoundStore::find(const StringId& id) const {
+  auto it = indices.find(id);
+  return it == indices.end() ? NONE : it->second;
+}
+
+CompoundStore::Index CompoundStore::insert(const StringId& id) {
+  auto result = indices.emplace(id, static_cast<Index>(compounds.size()));
+  if(result.second) {
+    compounds.emplace_back();
+    ids.emplace_back(id);
+    parents.emplace_back(result.first->second);
+  }
+  return result.first->second;
+}
+
+CompoundStore::Index CompoundStore::resolve(Index index) const {
+  Index root = index;
+  while(parents[root] != root)
+    root = parents[root];
+  while(parents[index] != root) {
+    Index next = parents[index];
+    parents[index] = root;
+    index = next;
+  }
+  return root;
+}
+
+void CompoundStore::setAlias(const StringId& alias, const StringId& target) {
+  Index a = insert(alias);
+  Index t = resolve(insert(target));
+  if(a == t)
+    return;
+  compounds[a].refId = target;
+  parents[a] = t;
+}
+
+std::vector<CompoundStore::Index> CompoundStore::getSortedIndices() const {
+  std::vector<Index> result(compounds.size());
+  for(Index i=0; i<result.size(); ++i)
+    result[i] = i;
+  std::sort(result.begin(), result.end(), [this](Index a, Index b) {
+    return toString(ids[a]) < toString(ids[b]);
+  });
+  return result;
+}
+
+// -------------------------------------------------
+
+size_t HeaderRegistry::addFiles(size_t count) {
+  std::lock_guard<std::mutex> lock(mutex);
+  size_t first = fileCount;
+  fileCount += count;
+  return first;
+}
+
+bool HeaderRegistry::claim(const HeaderKey& key) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& entry = entries[key];
+  bool visit = !entry.claimed || !skipClaimed;
+  entry.claimed = true;
+  return visit;
+}
+
+void HeaderRegistry::publish(const HeaderKey& key, std::unique_ptr<ParsingContext> fragment, size_t inputIndex) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& entry = entries[key];
+  entry.claimed = true;
+  // the results are taken when the first including unit is merged, all units before it have published already
+  if(entry.taken || (entry.published && entry.inputIndex <= inputIndex))
+    return;
+  entry.fragment = std::move(fragment);
+  entry.inputIndex = inputIndex;
+  entry.published = true;
+  published.notify_all();
+}
+
+std::unique_ptr<ParsingContext> HeaderRegistry::take(const HeaderKey& key) {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto& entry = entries[key];
+  published.wait(lock, [&]() { return entry.published; });
+  if(entry.taken)
+    return nullptr;
+  entry.taken = true;
+  return std::move(entry.fragment);
+}
+
+// -------------------------------------------------
+
+// main file & offsets of the inclusions in the main file
+struct IncludeOffsets {
+  CXFile mainFile = nullptr;
+  std::vector<std::pair<CXFile, unsigned int>> offsets;
+};
+
+void collectIncludeOffset(CXFile file, CXSourceLocation* stack, unsigned int stackSize, CXClientData data) {
+  auto& includes = *reinterpret_cast<IncludeOffsets*>(data);
+  if(stackSize == 0) {
+    includes.mainFile = file;
+    return;
+  }
+  // the last entry of the stack is the inclusion in the main file
+  unsigned int offset = 0;
+  clang_getSpellingLocation(stack[stackSize-1], nullptr, nullptr, nullptr, &offset);
+  includes.offsets.emplace_back(file, offset);
+}
+
+// hash of the #define & #undef directives of the main file preceding the (first) inclusion of a file,
+// headers might expand differently depending on them (0 if there are none)
+uint64_t getIncludeDefines(CXFile file, ParsingContext* context) {
+  if(!context->includeDefinesValid) {
+    context->includeDefinesValid = true;
+    IncludeOffsets includes;
+    clang_getInclusions(context->tu, *collectIncludeOffset, &includes);
+    size_t size = 0;
+    const char* text = includes.mainFile ? clang_getFileContents(context->tu, includes.mainFile, &size) : nullptr;
+    // accumulated hashes of the directives by their end offset
+    std::vector<std::pair<size_t, uint64_t>> directives;
+    for(size_t i=0; text && i<size;) {
+      size_t end = i;
+      while(end < size && (text[end] != '\n' || (end > i && text[end-1] == '\\')))
+        ++end;
+      size_t j = i;
+      while(j < size && (text[j] == ' ' || text[j] == '\t'))
+        ++j;
+      if(j < size && text[j] == '#') {
+        ++j;
+        while(j < size && (text[j] == ' ' || text[j] == '\t'))
+          ++j;
+        if((size - j >= 6 && std::strncmp(text + j, "define", 6) == 0) || (size - j >= 5 && std::strncmp(text + j, "undef", 5) == 0)) {
+          uint64_t hash = directives.empty() ? hashData(text + i, end - i) : hashData(text + i, end - i, directives.back().second);
+          directives.emplace_back(end, hash);
+        }
+      }
+      i = end + 1;
+    }
+    for(auto& v : includes.offsets) {
+      auto it = std::upper_bound(directives.begin(), directives.end(), std::make_pair(static_cast<size_t>(v.second), uint64_t(0)),
+        [](const std::pair<size_t, uint64_t>& a, const std::pair<size_t, uint64_t>& b) { return a.first < b.first; });
+      context->includeDefines.emplace(v.first, it == directives.begin() ? 0 : (it-1)->second);
     }
-    return CXChildVisit_Continue;
   }
-  return CXChildVisit_Recurse;
+  auto it = context->includeDefines.find(file);
+  return it != context->includeDefines.end() ? it->second : 0;
+}
+
+// -------------------------------------------------
+
+// returns the context that collects the declarations of the file at the given location
+ParsingContext* getVisitTarget(CXSourceLocation location, ParsingContext* context) {
+  CXFile file = nullptr;
+  clang_getExpansionLocation(location, &file, nullptr, nullptr, nullptr);
+  if(!file)
+    return context;
+  // file handles are unique per translation unit
+  auto it = context->fileTargets.find(file);
+  if(it != context->fileTargets.end())
+    return it->second;
+  
+  ParsingContext* target = nullptr;
+  if(clang_Location_isInSystemHeader(location)) {
+    target = nullptr;
+  } else if(clang_Location_isFromMainFile(location)) {
+    target = context;
+  } else {
+    auto path = getRealPath(toString(clang_getFileName(file)));
+    if(!context->scope || context->scope->contains(path)) {
+      HeaderKey key{hashData(path.data(), path.size()), context->argsHash};
+      uint64_t defines = getIncludeDefines(file, context);
+      if(defines != 0)
+        key.args = hashData(reinterpret_cast<const char*>(&defines), sizeof(defines), key.args);
+      auto fragmentIt = std::find_if(context->headerFragments.begin(), context->headerFragments.end(), 
+        [&](const std::pair<HeaderKey, std::unique_ptr<ParsingContext>>& v) { return v.first == key; });
+      if(fragmentIt != context->headerFragments.end()) {
+        target = fragmentIt->second.get();
+      } else if(std::find(context->includedHeaders.begin(), context->includedHeaders.end(), key) == context->includedHeaders.end()) {
+        context->includedHeaders.emplace_back(key);
+        // headers are only visited by the first translation unit that includes them
+        if(!context->headers || context->headers->claim(key)) {
+          std::unique_ptr<ParsingContext> fragment(new ParsingContext);
+          fragment->tokens = context->tokens;
+          fragment->ast = context->ast;
+          fragment->stats = context->stats;
+          target = fragment.get();
+          context->headerFragments.emplace_back(key, std::move(fragment));
+        }
+      }
+    }
+  }
+  context->fileTargets.emplace(file, target);
+  return target;
 }
 
 // -------------------------------------------------
 
 CXChildVisitResult visitRoot(CXCursor cursor, CXCursor parent, CXClientData data) {
-  auto context = reinterpret_cast<ParsingContext*>(data);  
-  CXCursorKind kind = clang_getCursorKind(cursor);
   auto location = clang_getCursorLocation(cursor);
+  auto context = getVisitTarget(location, reinterpret_cast<ParsingContext*>(data));
+  if(!context)
+    return CXChildVisit_Continue;
+  CXCursorKind kind = clang_getCursorKind(cursor);
   
   //if(!clang_Location_isFromMainFile(location))
   //  return CXChildVisit_Continue;
-  if(clang_Location_isInSystemHeader(location))
-    return CXChildVisit_Continue;
   /*if(kind == CXCursor_MacroExpansion) {  
     if(name.compare(0, 6, "ES_FUN") == 0 || name.compare(0, 7, "ES_MFUN") == 0 || name.compare(0, 7, "ES_CTOR") == 0) {
       std::cout << "macro " << name << " -> " << getCursorKindName(kind) << std::endl;
@@ -619,26 +792,19 @@ CXChildVisitResult visitRoot(CXCursor cursor, CXCursor parent, CXClientData data
         return CXChildVisit_Continue;
         
       int argc = clang_Cursor_getNumArguments(cursor);
-      if(argc != 1 || !hasType(clang_Cursor_getArgument(cursor, 0), "EScript::Namespace")) {
+      if(argc != 1 || context->ast->getTypeClass(clang_Cursor_getArgument(cursor, 0)) != AstIndex::NAMESPACE) {
         return CXChildVisit_Continue;
       }
-      context->activeInit.id = toString(clang_getCursorUSR(cursor));
-      context->activeInit.paramId = toString(clang_getCursorUSR(clang_Cursor_getArgument(cursor, 0)));
+      TraceSpan span("init");
+      context->activeInit.id = getCursorId(cursor);
+      context->activeInit.paramId = getCursorId(clang_Cursor_getArgument(cursor, 0));
       context->activeInit.location = getCursorLocation(cursor);
-      DEBUG2("init ")
       resolveCompound(clang_Cursor_getArgument(cursor, 0), context);
-      auto& call = context->initCalls[context->activeInit.id];
-      if(!call.group.empty()) {
-        context->activeInit.group = call.group;
-        //context->activeGroup = call.group;
-        //context->groupBlock = true;
-      } else {
-        context->activeInit.group = StringId();
-      }
       
-      DEBUG1("init " << context->activeInit.id);
+      if(span.isActive())
+        span.setDetail(toString(context->activeInit.id));
       extractComments(cursor, context);
-      clang_visitChildren(cursor, *visitInitFunction, context);
+      visitInitFunction(cursor, context);
           
       //for(auto& v : context->initCalls)
       //  std::cout << "  init " << v.first << " (" << v.second.lib << ") @ " << std::endl;
@@ -650,8 +816,8 @@ CXChildVisitResult visitRoot(CXCursor cursor, CXCursor parent, CXClientData data
       context->activeMemberGroup = StringId();
       context->memberGroupBlock = false;
     } else if(name == "getClassName") {
-      auto clname = extractStringLiteral(cursor);
-      StringId id = toString(clang_getCursorUSR(cursor));
+      auto clname = extractStringLiteral(cursor, *context->tokens);
+      StringId id = getCursorId(cursor);
       if(!clname.empty()) {
         context->names[id] = clname;
       }
@@ -661,182 +827,1002 @@ CXChildVisitResult visitRoot(CXCursor cursor, CXCursor parent, CXClientData data
   return CXChildVisit_Recurse;
 }
 
+// -------------------------------------------------
+
+std::vector<const char*> getCompilerArgs(const std::vector<std::string>& include, const char* language="c++") {
+  // = { "-x", "c++", "-Wdocumentation", "-fparse-all-comments", "-Itest", "-Itest/EScript", "-Itest/E_Util" };
+  std::vector<const char*> args;
+  args.reserve(include.size() + 7);
+  args.emplace_back("-x");
+  args.emplace_back(language);
+  args.emplace_back("-std=c++11");
+  //args.emplace_back("-Wdocumentation");
+  args.emplace_back("-fparse-all-comments");
+  args.emplace_back("-Wno-inconsistent-missing-override");
+  #ifdef _WIN32
+    args.emplace_back("--target=x86_64-w64-mingw32");
+  #endif
+  for(auto& s : include) 
+    args.emplace_back(s.c_str());
+  return args;
+}
+
+// -------------------------------------------------
+
+void collectInclusion(CXFile file, CXSourceLocation* /*stack*/, unsigned int stackSize, CXClientData data) {
+  if(stackSize > 0)
+    reinterpret_cast<std::vector<std::string>*>(data)->emplace_back(toString(clang_getFileName(file)));
+}
+
+// -------------------------------------------------
+
+// visits the parsed translation unit of the context, the unit is kept
+void visitTranslationUnit(ParsingContext* context, std::vector<std::string>* inclusions=nullptr) {
+  Stopwatch watch;
+  TokenIndex tokens(context->tu);
+  AstIndex ast;
+  context->tokens = &tokens;
+  context->ast = &ast;
+  CXCursor rootCursor = clang_getTranslationUnitCursor(context->tu);  
+  {
+    TraceSpan span("visitRoot");
+    clang_visitChildren(rootCursor, *visitRoot, context);
+  }
+  if(context->stats) {
+    context->stats->visit = watch.getWallTime();
+    context->stats->visitCpu = watch.getCpuTime();
+    context->stats->tokens = tokens.getTokenCount();
+  }
+  context->tokens = nullptr;
+  context->ast = nullptr;
+  for(auto& fragment : context->headerFragments) {
+    fragment.second->tokens = nullptr;
+    fragment.second->ast = nullptr;
+    fragment.second->stats = nullptr;
+  }
+  if(inclusions)
+    clang_getInclusions(context->tu, *collectInclusion, inclusions);
+  context->fileTargets.clear();
+  context->includeDefines.clear();
+  context->includeDefinesValid = false;
+}
+
+// -------------------------------------------------
+
+// parses & visits a file, if keepUnit is set the unit is parsed for fast reparsing and stays in context->tu
+bool parseTranslationUnit(const std::string& filename, const std::vector<std::string>& include, ParsingContext* context, std::vector<std::string>* inclusions=nullptr, bool keepUnit=false) {
+  auto args = getCompilerArgs(include);
+  unsigned int options = keepUnit ? clang_defaultEditingTranslationUnitOptions() : static_cast<unsigned int>(CXTranslationUnit_None);
+  unsigned int unsavedCount = context->unsavedFiles ? static_cast<unsigned int>(context->unsavedFiles->size()) : 0;
+  CXUnsavedFile* unsaved = unsavedCount > 0 ? const_cast<CXUnsavedFile*>(context->unsavedFiles->data()) : nullptr;
+  Stopwatch watch;
+  context->tu = clang_parseTranslationUnit(context->index, filename.c_str(), args.data(), args.size(), unsaved, unsavedCount, options);
+  //CXTranslationUnit translationUnit = clang_parseTranslationUnit(index, 0, argv, argc, 0, 0, CXTranslationUnit_None);
+  
+  if(!context->tu) {
+    std::cerr << std::endl << "error creating translationUnit for " << filename << std::endl;
+    return false;
+  }
+  
+  if(context->stats) {
+    context->stats->parse = watch.getWallTime();
+    context->stats->parseCpu = watch.getCpuTime();
+  }
+  
+  visitTranslationUnit(context, inclusions);
+  if(!keepUnit) {
+    clang_disposeTranslationUnit(context->tu);
+    context->tu = nullptr;
+  }
+  return true;
+}
+
+// -------------------------------------------------
+
+void publishHeaders(ParsingContext* context) {
+  if(!context->headers)
+    return;
+  for(auto& v : context->headerFragments)
+    context->headers->publish(v.first, std::move(v.second), context->inputIndex);
+  context->headerFragments.clear();
+}
+
+// -------------------------------------------------
+
+// identifies the compiler arguments & the scope of a run
+std::string getArgsKey(const std::vector<std::string>& include, const SourceScope* scope) {
+  std::string key;
+  for(auto arg : getCompilerArgs(include))
+    key += std::string(arg) + "\n";
+  if(scope) {
+    for(auto& path : scope->include)
+      key += "+" + path + "\n";
+    for(auto& path : scope->exclude)
+      key += "-" + path + "\n";
+  }
+  return key;
+}
+
+// -------------------------------------------------
+
+void extractFile(const std::string& filename, const std::vector<std::string>& include, ResultCache* cache, ParsingContext* context) {
+  TraceSpan span("parseFile");
+  span.setDetail(filename);
+  std::string key = getArgsKey(include, context->scope);
+  context->argsHash = hashData(key.data(), key.size());
+  
+  if(!cache) {
+    parseTranslationUnit(filename, include, context);
+    publishHeaders(context);
+    return;
+  }
+  if(cache->load(filename, key, context)) {
+    if(context->stats)
+      context->stats->cached = true;
+    publishHeaders(context);
+    return;
+  }
+  std::vector<std::string> inclusions;
+  if(parseTranslationUnit(filename, include, context, &inclusions)) {
+    std::sort(inclusions.begin(), inclusions.end());
+    inclusions.erase(std::unique(inclusions.begin(), inclusions.end()), inclusions.end());
+    cache->store(filename, key, inclusions, context);
+  }
+  publishHeaders(context);
+}
+
+// -------------------------------------------------
+
+template<class Map>
+std::vector<typename Map::value_type*> getSortedEntries(Map& map) {
+  std::vector<typename Map::value_type*> entries;
+  entries.reserve(map.size());
+  for(auto& v : map)
+    entries.emplace_back(&v);
+  std::sort(entries.begin(), entries.end(), [](typename Map::value_type* a, typename Map::value_type* b) {
+    return toString(a->first) < toString(b->first);
+  });
+  return entries;
+}
+
+// -------------------------------------------------
+
+StringId resolveAlias(const StringId& id, const ParsingContext* context) {
+  auto index = context->compounds.find(id);
+  if(index == CompoundStore::NONE)
+    return id;
+  return context->compounds.getId(context->compounds.resolve(index));
+}
+
+// merges the results of a single translation unit into the global context
+void mergeContext(ParsingContext* target, ParsingContext* source) {
+  for(auto& v : source->names)
+    target->names[v.first] = std::move(v.second);
+  
+  // iterate in a fixed order, the content of the maps depends on how they were filled (e.g., cache)
+  auto sourceCompounds = source->compounds.getSortedIndices();
+  auto sourceInitCalls = getSortedEntries(source->initCalls);
+  
+  // move the members & references, the handles of the source are shifted behind the ones of the target
+  auto memberOffset = static_cast<MemberHandle>(target->members.size());
+  auto referenceOffset = static_cast<ReferenceHandle>(target->references.size());
+  for(CompoundStore::Index i=0; i<source->compounds.size(); ++i) {
+    auto& cmp = source->compounds[i];
+    for(auto& h : cmp.member)
+      h += memberOffset;
+    for(auto& h : cmp.children)
+      h += referenceOffset;
+  }
+  for(auto& entry : source->pendingGroups)
+    entry.handle += entry.kind == PendingGroupEntry::CHILD ? referenceOffset : memberOffset;
+  std::move(source->members.begin(), source->members.end(), std::back_inserter(target->members));
+  std::move(source->references.begin(), source->references.end(), std::back_inserter(target->references));
+  source->members.clear();
+  source->references.clear();
+  
+  // merge compounds
+  std::vector<std::pair<StringId,StringId>> aliases;
+  for(auto index : sourceCompounds) {
+    auto& cmp = source->compounds[index];
+    auto& id = source->compounds.getId(index);
+    if(cmp.isRef()) {
+      aliases.emplace_back(id, resolveAlias(cmp.refId, source));
+      continue;
+    }
+    auto& targetCmp = getCompound(id, target);
+    if(targetCmp.isNull())
+      targetCmp.id = id;
+    mergeCompoundData(targetCmp, cmp, target, true);
+  }
+  for(auto& alias : aliases) {
+    auto& c1 = getCompound(alias.second, target);
+    auto& c2 = getCompound(alias.first, target);
+    if(c2.isNull()) {
+      c2.id = alias.first;
+      target->compounds.setAlias(alias.first, c1.id);
+    } else {
+      mergeCompounds(c1, c2, target, true);
+    }
+  }
+  
+  // the init hierarchy is resolved after all files are merged
+  target->pendingGroups.insert(target->pendingGroups.end(), source->pendingGroups.begin(), source->pendingGroups.end());
+  source->pendingGroups.clear();
+  for(auto* v : sourceInitCalls)
+    target->initCalls[v->first] = std::move(v->second);
+}
+
+// -------------------------------------------------
+
+// group of the call of an init function, entries declared on its parameter without a group are added to it;
+// the group of a call is not inherited by the init functions called in turn
+StringId getInitGroup(const StringId& id, const ParsingContext* context) {
+  auto it = context->initCalls.find(id);
+  return it != context->initCalls.end() ? it->second.group : StringId();
+}
+
+// second phase after merging: the result does not depend on the order the files were merged in
+void resolveInitCalls(ParsingContext* context) {
+  TraceSpan span("resolveInitCalls");
+  // the compound of each called init function is merged into the compound it is called with
+  for(auto* v : getSortedEntries(context->initCalls)) {
+    auto& call = v->second;
+    auto& lib = getCompound(call.lib, context);
+    auto& initCmp = getCompound(call.id, context);
+    if(lib.isNull())
+      continue;
+    if(initCmp.isNull())
+      initCmp.id = call.id;
+    mergeCompounds(lib, initCmp, context);
+  }
+  
+  // entries are kept until their init call is known, more files might be merged later
+  std::vector<PendingGroupEntry> pending;
+  for(auto& entry : context->pendingGroups) {
+    auto grpId = getInitGroup(entry.init, context);
+    if(grpId.empty()) {
+      pending.emplace_back(entry);
+    } else if(entry.kind == PendingGroupEntry::CHILD) {
+      auto& c = getCompound(context->references[entry.handle].ref, context);
+      if(!c.isNull())
+        c.group = grpId;
+      context->compounds.at(grpId).children.emplace_back(entry.handle);
+    } else {
+      context->compounds.at(grpId).member.emplace_back(entry.handle);
+    }
+  }
+  context->pendingGroups.swap(pending);
+}
+
+// -------------------------------------------------
+
+// merges the results of a translation unit and all included headers that were not merged before
+void mergeFragment(ParsingContext* target, ParsingContext* fragment) {
+  TraceSpan span("mergeFragment");
+  for(auto& v : fragment->headerFragments) {
+    if(v.second)
+      mergeContext(target, v.second.get());
+  }
+  if(fragment->headers) {
+    for(auto& key : fragment->includedHeaders) {
+      auto header = fragment->headers->take(key);
+      if(header)
+        mergeContext(target, header.get());
+    }
+  }
+  mergeContext(target, fragment);
+}
+
+// merges the results of a translation unit that visited all of its headers, each header is only merged once
+void mergeUnit(ParsingContext* target, ParsingContext* fragment, std::unordered_set<HeaderKey, HeaderKeyHash>& mergedHeaders) {
+  for(auto& v : fragment->headerFragments) {
+    if(mergedHeaders.insert(v.first).second)
+      mergeContext(target, v.second.get());
+  }
+  mergeContext(target, fragment);
+}
+
+// -------------------------------------------------
+
+// the contents have to stay alive while the handles are used
+std::vector<CXUnsavedFile> getUnsavedFiles(const std::unordered_map<std::string, std::string>& files) {
+  std::vector<CXUnsavedFile> handles;
+  handles.reserve(files.size());
+  for(auto& v : files)
+    handles.push_back({v.first.c_str(), v.second.data(), static_cast<unsigned long>(v.second.size())});
+  return handles;
+}
+
+// -------------------------------------------------
+
+// translation units & extraction results of the incremental (watch) mode
+struct IncrementalState {
+  struct Unit {
+    std::string file;
+    CXTranslationUnit tu = nullptr;
+    // serialized results of the file including all of its in-scope headers
+    std::string fragment;
+    // real paths of the file & its in-scope includes
+    std::vector<std::string> dependencies;
+  };
+  // in input order
+  std::vector<Unit> units;
+  // indices of the worker threads owning some of the units
+  std::vector<CXIndex> indices;
+  // content hashes of the written json documents by file name
+  std::unordered_map<std::string, uint64_t> documents;
+  
+  ~IncrementalState() {
+    for(auto& unit : units) {
+      if(unit.tu)
+        clang_disposeTranslationUnit(unit.tu);
+    }
+    for(auto index : indices)
+      clang_disposeIndex(index);
+  }
+};
+
+// (re)parses the file of a unit, the headers are visited by every unit & deduplicated in rebuild()
+void extractUnit(IncrementalState::Unit& unit, const std::vector<std::string>& include, ParsingContext* context) {
+  std::string key = getArgsKey(include, context->scope);
+  context->argsHash = hashData(key.data(), key.size());
+  std::vector<std::string> inclusions;
+  bool valid = false;
+  if(unit.tu) {
+    TraceSpan span("reparseFile");
+    span.setDetail(unit.file);
+    unsigned int unsavedCount = context->unsavedFiles ? static_cast<unsigned int>(context->unsavedFiles->size()) : 0;
+    CXUnsavedFile* unsaved = unsavedCount > 0 ? const_cast<CXUnsavedFile*>(context->unsavedFiles->data()) : nullptr;
+    if(clang_reparseTranslationUnit(unit.tu, unsavedCount, unsaved, clang_defaultReparseOptions(unit.tu)) == 0) {
+      context->tu = unit.tu;
+      visitTranslationUnit(context, &inclusions);
+      valid = true;
+    } else {
+      // the unit can not be used anymore after a failed reparse
+      clang_disposeTranslationUnit(unit.tu);
+    }
+  }
+  if(!valid) {
+    TraceSpan span("parseFile");
+    span.setDetail(unit.file);
+    valid = parseTranslationUnit(unit.file, include, context, &inclusions, true);
+  }
+  unit.tu = context->tu;
+  context->tu = nullptr;
+  
+  unit.dependencies.clear();
+  unit.dependencies.emplace_back(getRealPath(unit.file));
+  for(auto& file : inclusions) {
+    auto path = getRealPath(file);
+    if(!context->scope || context->scope->contains(path))
+      unit.dependencies.emplace_back(path);
+  }
+  std::sort(unit.dependencies.begin(), unit.dependencies.end());
+  unit.dependencies.erase(std::unique(unit.dependencies.begin(), unit.dependencies.end()), unit.dependencies.end());
+  
+  unit.fragment.clear();
+  if(valid) {
+    std::ostringstream out;
+    BinaryWriter writer(out);
+    writeContext(writer, context);
+    unit.fragment = out.str();
+  }
+}
+
 // ==============================================================================
 
-Parser::Parser() : context(new ParsingContext) {
-  context->index = clang_createIndex(1, 1);
+Parser::Parser() : context(new ParsingContext), headers(new HeaderRegistry) {
+  // declarations from the precompiled header are still needed by the visitor
+  context->index = clang_createIndex(0, 1);
   if(!context->index)
     throw std::runtime_error("error creating index");
 }
 
 Parser::~Parser() {
+  // the units have to be disposed before their index
+  incremental.reset();
   clang_disposeIndex(context->index);
 }
 
+void Parser::setCacheDir(const std::string& path) {
+  if(path.empty())
+    cache.reset();
+  else
+    cache.reset(new ResultCache(path));
+  // cache entries have to contain the results of all included headers
+  headers->setSkipClaimed(!cache);
+}
+
+size_t Parser::getCacheHits() const {
+  return cache ? cache->getHits() : 0;
+}
+
+bool Parser::usePrecompiledHeader(const std::vector<std::string>& headers, const std::string& pchFile) {
+  if(headers.empty() || !pch.empty())
+    return false;
+  
+  std::string source;
+  for(auto& header : headers)
+    source += "#include \"" + header + "\"\n";
+  
+  // the pch is only valid for the same headers & arguments
+  auto args = getCompilerArgs(include, "c++-header");
+  uint64_t key = hashData(source.data(), source.size());
+  for(auto arg : args)
+    key = hashData(arg, std::strlen(arg) + 1, key);
+  
+  // check if the existing pch is still up to date
+  std::string stampFile = pchFile + ".stamp";
+  bool valid = IO::getEntryType(pchFile) == IO::TYPE_FILE && IO::getEntryType(stampFile) == IO::TYPE_FILE;
+  if(valid) {
+    std::ifstream stamp(stampFile);
+    uint64_t storedKey = 0;
+    stamp >> storedKey;
+    valid = stamp.good() && storedKey == key;
+    std::string file;
+    uint64_t hash;
+    while(valid && stamp >> hash && std::getline(stamp >> std::ws, file))
+      valid = hashFile(file) == hash;
+  }
+  
+  if(!valid) {
+    std::cout << "Building precompiled header " << pchFile << std::endl;
+    std::string sourceFile = pchFile + ".h";
+    CXUnsavedFile unsaved{sourceFile.c_str(), source.c_str(), static_cast<unsigned long>(source.size())};
+    unsigned int options = CXTranslationUnit_ForSerialization | CXTranslationUnit_Incomplete;
+    CXTranslationUnit tu = clang_parseTranslationUnit(context->index, sourceFile.c_str(), args.data(), args.size(), &unsaved, 1, options);
+    if(!tu) {
+      std::cerr << "error creating precompiled header translationUnit" << std::endl;
+      return false;
+    }
+    // concurrent runs (e.g., --compile jobs) must never load a partially written pch,
+    // both files are written under unique names and replaced atomically
+    std::string tmpFile = getTempPath(pchFile);
+    bool saved = clang_saveTranslationUnit(tu, tmpFile.c_str(), clang_defaultSaveOptions(tu)) == CXSaveError_None;
+    std::vector<std::string> inclusions;
+    clang_getInclusions(tu, *collectInclusion, &inclusions);
+    clang_disposeTranslationUnit(tu);
+    if(!saved || std::rename(tmpFile.c_str(), pchFile.c_str()) != 0) {
+      std::remove(tmpFile.c_str());
+      std::cerr << "error writing precompiled header '" << pchFile << "'" << std::endl;
+      return false;
+    }
+    std::sort(inclusions.begin(), inclusions.end());
+    inclusions.erase(std::unique(inclusions.begin(), inclusions.end()), inclusions.end());
+    std::string tmpStamp = getTempPath(stampFile);
+    {
+      std::ofstream stamp(tmpStamp, std::ios::trunc);
+      stamp << key << "\n";
+      for(auto& file : inclusions)
+        stamp << hashFile(file) << " " << file << "\n";
+    }
+    // without a stamp the pch is rebuilt by the next run
+    if(std::rename(tmpStamp.c_str(), stampFile.c_str()) != 0)
+      std::remove(tmpStamp.c_str());
+  }
+  
+  pch = pchFile;
+  include.emplace_back("-include-pch");
+  include.emplace_back(pch);
+  return true;
+}
+
+void Parser::setScope(const std::vector<std::string>& include, const std::vector<std::string>& exclude) {
+  scope.reset(new SourceScope);
+  for(auto& path : include)
+    scope->include.emplace_back(getRealPath(path));
+  for(auto& path : exclude)
+    scope->exclude.emplace_back(getRealPath(path));
+}
+
 void Parser::addDefinition(const std::string& def) {
   include.emplace_back("-D" + def);
 }
 
 void Parser::addFlag(const std::string& flag) {
   include.emplace_back(flag);
+  flags.emplace_back(flag);
+}
+
+// -o<path>, but not other options starting with -o like -objc-arc or -objcmt-*
+static bool isJoinedOutput(const std::string& arg) {
+  return arg.size() > 2 && arg.compare(0, 2, "-o") == 0 && arg.compare(0, 4, "-obj") != 0;
+}
+
+// -------------------------------------------------
+
+bool Parser::loadCompilationDatabase(const std::string& buildDir, std::vector<std::string>* files) {
+  CXCompilationDatabase_Error error;
+  CXCompilationDatabase db = clang_CompilationDatabase_fromDirectory(buildDir.c_str(), &error);
+  if(error != CXCompilationDatabase_NoError || !db)
+    return false;
+  
+  CXCompileCommands commands = clang_CompilationDatabase_getAllCompileCommands(db);
+  unsigned int count = clang_CompileCommands_getSize(commands);
+  for(unsigned int i=0; i<count; ++i) {
+    CXCompileCommand command = clang_CompileCommands_getCommand(commands, i);
+    std::string directory = toString(clang_CompileCommand_getDirectory(command));
+    std::string filename = toString(clang_CompileCommand_getFilename(command));
+    if(!filename.empty() && filename[0] != '/' && filename.find(':') == std::string::npos)
+      filename = directory + "/" + filename;
+    filename = getRealPath(filename);
+    
+    // keep everything that affects parsing, drop compiler, input, output & dependency file arguments
+    std::vector<std::string> args;
+    if(!directory.empty())
+      args.emplace_back("-working-directory=" + directory);
+    unsigned int argc = clang_CompileCommand_getNumArgs(command);
+    for(unsigned int j=1; j<argc; ++j) {
+      std::string arg = toString(clang_CompileCommand_getArg(command, j));
+      if(arg == "-o" || arg == "-MF" || arg == "-MT" || arg == "-MQ") {
+        ++j;
+      } else if(arg == "-c" || arg == "-MD" || arg == "-MMD" || arg == "--" || isJoinedOutput(arg)) {
+        continue;
+      } else if(!arg.empty() && arg[0] != '-' && getRealPath(arg[0] == '/' ? arg : directory + "/" + arg) == filename) {
+        continue;
+      } else {
+        args.emplace_back(arg);
+      }
+    }
+    for(auto& flag : flags)
+      args.emplace_back(flag);
+    if(files && fileArgs.find(filename) == fileArgs.end())
+      files->emplace_back(filename);
+    fileArgs[filename] = std::move(args);
+  }
+  clang_CompileCommands_dispose(commands);
+  clang_CompilationDatabase_dispose(db);
+  if(files)
+    std::sort(files->begin(), files->end());
+  return true;
+}
+
+const std::vector<std::string>& Parser::getArgs(const std::string& filename) const {
+  if(fileArgs.empty())
+    return include;
+  auto it = fileArgs.find(getRealPath(filename));
+  return it != fileArgs.end() ? it->second : include;
 }
 
 void Parser::addInclude(const std::string& path) {
   include.emplace_back("-I" + path);
 }
 
+void Parser::enableStatistics() {
+  if(!stats)
+    stats.reset(new Statistics);
+}
+
+void Parser::enableIncremental() {
+  if(!incremental)
+    incremental.reset(new IncrementalState);
+}
+
+void Parser::addUnsavedFile(const std::string& filename, const std::string& content) {
+  unsavedFiles[filename] = content;
+}
+
 void Parser::parseFile(const std::string& filename) {
-  // = { "-x", "c++", "-Wdocumentation", "-fparse-all-comments", "-Itest", "-Itest/EScript", "-Itest/E_Util" };
-  std::vector<const char*> args;
-  args.reserve(include.size() + 7);
-  args.emplace_back("-x");
-  args.emplace_back("c++");
-  args.emplace_back("-std=c++11");
-  //args.emplace_back("-Wdocumentation");
-  args.emplace_back("-fparse-all-comments");
-  args.emplace_back("-Wno-inconsistent-missing-override");
-  #ifdef _WIN32
-    args.emplace_back("--target=x86_64-w64-mingw32");
-  #endif
-  for(auto& s : include) 
-    args.emplace_back(s.c_str());
+  mergeFile(filename);
+}
+
+// extracts & merges a file, the init hierarchy is resolved once before the model is used (see resolve())
+void Parser::mergeFile(const std::string& filename) {
+  resolved = false;
+  auto unsaved = getUnsavedFiles(unsavedFiles);
+  ParsingContext fragment;
+  fragment.index = context->index;
+  fragment.scope = scope.get();
+  fragment.headers = headers.get();
+  fragment.unsavedFiles = &unsaved;
+  fragment.stats = stats ? stats->addFiles({filename}) : nullptr;
+  fragment.inputIndex = headers->addFiles(1);
+  if(incremental) {
+    fragment.headers = nullptr;
+    incremental->units.emplace_back();
+    incremental->units.back().file = filename;
+    extractUnit(incremental->units.back(), getArgs(filename), &fragment);
+    return;
+  }
+  // cache entries are only valid for the files on disk
+  extractFile(filename, getArgs(filename), unsavedFiles.empty() ? cache.get() : nullptr, &fragment);
+  Stopwatch watch;
+  mergeFragment(context.get(), &fragment);
+  if(stats)
+    stats->addPhase(Statistics::RESOLVE, watch);
+}
+
+void Parser::parseBuffer(const std::string& filename, const std::string& content) {
+  addUnsavedFile(filename, content);
+  parseFile(filename);
+}
+
+void Parser::parseFiles(const std::vector<std::string>& files, unsigned int threads, const ProgressCallback& progress) {
+  if(threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  if(threads > files.size())
+    threads = static_cast<unsigned int>(files.size());
   
-  context->tu = clang_parseTranslationUnit(context->index, filename.c_str(), args.data(), args.size(), nullptr, 0, CXTranslationUnit_None);
-  //CXTranslationUnit translationUnit = clang_parseTranslationUnit(index, 0, argv, argc, 0, 0, CXTranslationUnit_None);
+  auto unsaved = getUnsavedFiles(unsavedFiles);
+  ResultCache* activeCache = unsavedFiles.empty() ? cache.get() : nullptr;
   
-  /*Compound* root = nullptr;
-  for(auto& c : context->compounds) {
-    if(cmp.parentId.empty()) {
-      if(!root)
-        root = &cmp;
-      else
-        mergeCompounds(*root, cmp, context.get());
+  // the model of the incremental mode is built from the results of all units at the end
+  size_t firstUnit = 0;
+  if(incremental) {
+    firstUnit = incremental->units.size();
+    incremental->units.resize(firstUnit + files.size());
+    for(size_t i=0; i<files.size(); ++i)
+      incremental->units[firstUnit + i].file = files[i];
+  }
+  
+  if(threads <= 1) {
+    for(size_t i=0; i<files.size(); ++i) {
+      if(progress)
+        progress(files[i], i);
+      if(!incremental) {
+        mergeFile(files[i]);
+        continue;
+      }
+      ParsingContext fragment;
+      fragment.index = context->index;
+      fragment.scope = scope.get();
+      fragment.unsavedFiles = &unsaved;
+      fragment.stats = stats ? stats->addFiles({files[i]}) : nullptr;
+      extractUnit(incremental->units[firstUnit + i], getArgs(files[i]), &fragment);
     }
-  }*/
+    resolved = false;
+    resolve();
+    return;
+  }
   
-  if(!context->tu) {
-    std::cerr << std::endl << "error creating translationUnit" << std::endl;
+  // each worker owns its own index and parses every file into a private context,
+  // the results are merged in input order to produce the same model as a serial run
+  std::vector<std::unique_ptr<ParsingContext>> results(files.size());
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  FileStats* fileStats = stats ? stats->addFiles(files) : nullptr;
+  size_t firstIndex = headers->addFiles(files.size());
+  for(unsigned int t=0; t<threads; ++t) {
+    workers.emplace_back([&]() {
+      CXIndex index = clang_createIndex(0, 1);
+      for(size_t i = next++; i < files.size(); i = next++) {
+        std::unique_ptr<ParsingContext> fragment(new ParsingContext);
+        fragment->index = index;
+        fragment->scope = scope.get();
+        fragment->headers = incremental ? nullptr : headers.get();
+        fragment->unsavedFiles = &unsaved;
+        fragment->stats = fileStats ? fileStats + i : nullptr;
+        fragment->inputIndex = firstIndex + i;
+        if(index && incremental)
+          extractUnit(incremental->units[firstUnit + i], getArgs(files[i]), fragment.get());
+        else if(index)
+          extractFile(files[i], getArgs(files[i]), activeCache, fragment.get());
+        std::lock_guard<std::mutex> lock(mutex);
+        results[i] = std::move(fragment);
+        ready.notify_one();
+      }
+      if(index && incremental) {
+        // the units of the worker are still alive
+        std::lock_guard<std::mutex> lock(mutex);
+        incremental->indices.emplace_back(index);
+      } else if(index) {
+        clang_disposeIndex(index);
+      }
+    });
+  }
+  
+  for(size_t i=0; i<files.size(); ++i) {
+    std::unique_ptr<ParsingContext> fragment;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      ready.wait(lock, [&]() { return results[i] != nullptr; });
+      fragment = std::move(results[i]);
+    }
+    if(progress)
+      progress(files[i], i);
+    if(incremental)
+      continue;
+    Stopwatch watch;
+    mergeFragment(context.get(), fragment.get());
+    if(stats)
+      stats->addPhase(Statistics::RESOLVE, watch);
+  }
+  for(auto& worker : workers)
+    worker.join();
+  resolved = false;
+  resolve();
+}
+
+// resolves the init hierarchy once after files were merged (the model is rebuilt in incremental mode)
+void Parser::resolve() const {
+  if(resolved)
     return;
+  if(incremental) {
+    rebuild();
+    return;
+  }
+  Stopwatch watch;
+  resolveInitCalls(context.get());
+  resolved = true;
+  if(stats)
+    stats->addPhase(Statistics::RESOLVE, watch);
+}
+
+bool Parser::compileFile(const std::string& filename, const std::string& artifact) {
+  auto unsaved = getUnsavedFiles(unsavedFiles);
+  ParsingContext fragment;
+  fragment.index = context->index;
+  fragment.scope = scope.get();
+  fragment.unsavedFiles = &unsaved;
+  fragment.stats = stats ? stats->addFiles({filename}) : nullptr;
+  // without a registry all in-scope headers are visited, they are deduplicated when linking
+  std::string key = getArgsKey(getArgs(filename), scope.get());
+  fragment.argsHash = hashData(key.data(), key.size());
+  {
+    TraceSpan span("parseFile");
+    span.setDetail(filename);
+    if(!parseTranslationUnit(filename, getArgs(filename), &fragment))
+      return false;
+  }
+  Stopwatch watch;
+  bool success = writeArtifact(artifact, filename, &fragment);
+  if(!success)
+    std::cerr << std::endl << "could not write " << artifact << "." << std::endl;
+  if(stats)
+    stats->addPhase(Statistics::WRITE, watch);
+  return success;
+}
+
+bool Parser::linkFiles(const std::vector<std::string>& artifacts) {
+  Stopwatch watch;
+  bool success = true;
+  std::unordered_set<HeaderKey, HeaderKeyHash> mergedHeaders;
+  for(auto& artifact : artifacts) {
+    TraceSpan span("linkFile");
+    span.setDetail(artifact);
+    ParsingContext fragment;
+    std::string source;
+    if(!readArtifact(artifact, source, &fragment)) {
+      std::cerr << std::endl << "invalid compiled file " << artifact << "." << std::endl;
+      success = false;
+      continue;
+    }
+    mergeUnit(context.get(), &fragment, mergedHeaders);
+  }
+  resolveInitCalls(context.get());
+  if(stats)
+    stats->addPhase(Statistics::RESOLVE, watch);
+  return success;
+}
+
+size_t Parser::update(const std::vector<std::string>& changedFiles) {
+  if(!incremental)
+    return 0;
+  std::unordered_set<std::string> changed;
+  for(auto& file : changedFiles)
+    changed.insert(getRealPath(file));
+  auto unsaved = getUnsavedFiles(unsavedFiles);
+  size_t count = 0;
+  for(auto& unit : incremental->units) {
+    if(std::none_of(unit.dependencies.begin(), unit.dependencies.end(), [&](const std::string& f) { return changed.count(f) > 0; }))
+      continue;
+    ParsingContext fragment;
+    fragment.index = context->index;
+    fragment.scope = scope.get();
+    fragment.unsavedFiles = &unsaved;
+    extractUnit(unit, getArgs(unit.file), &fragment);
+    ++count;
+  }
+  if(count > 0)
+    rebuild();
+  return count;
+}
+
+std::vector<std::string> Parser::getDependencies() const {
+  std::vector<std::string> files;
+  if(!incremental)
+    return files;
+  for(auto& unit : incremental->units)
+    files.insert(files.end(), unit.dependencies.begin(), unit.dependencies.end());
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  return files;
+}
+
+// merges the stored results of all units in input order, only the parsing is incremental
+void Parser::rebuild() const {
+  TraceSpan span("rebuild");
+  Stopwatch watch;
+  std::unique_ptr<ParsingContext> model(new ParsingContext);
+  model->index = context->index;
+  std::unordered_set<HeaderKey, HeaderKeyHash> mergedHeaders;
+  for(auto& unit : incremental->units) {
+    if(unit.fragment.empty())
+      continue;
+    ParsingContext fragment;
+    std::istringstream in(unit.fragment);
+    BinaryReader reader(in);
+    if(!readContext(reader, &fragment)) {
+      std::cerr << std::endl << "invalid results of " << unit.file << "." << std::endl;
+      continue;
+    }
+    mergeUnit(model.get(), &fragment, mergedHeaders);
   }
+  resolveInitCalls(model.get());
+  // views of the previous model become invalid
+  *context = std::move(*model);
+  resolved = true;
+  if(stats)
+    stats->addPhase(Statistics::RESOLVE, watch);
+}
+
+void Parser::computeFullnames() const {
+  Stopwatch watch;
+  auto& compounds = context->compounds;
   
-  DEBUG1(std::endl << "parsing " << filename);
-  CXCursor rootCursor = clang_getTranslationUnitCursor(context->tu);  
-  clang_visitChildren(rootCursor, *visitRoot, context.get());  
-  clang_disposeTranslationUnit(context->tu);
-  context->tu = nullptr;
+  // groups are placed below the compound of their first entry
+  for(CompoundStore::Index i=0; i<compounds.size(); ++i) {
+    auto& cmp = compounds[i];
+    if(cmp.isRef() || cmp.name.empty() || cmp.kind != Compound::GROUP)
+      continue;
+    if(!cmp.children.empty()) {
+      cmp.parentId = findCompound(context->references[cmp.children.front()].compound, context.get()).id;
+    } else if(!cmp.member.empty()) {
+      cmp.parentId = findCompound(context->members[cmp.member.front()].compound, context.get()).id;
+    }
+  }
+  
+  // parents before children, the prefix of a compound is the full name of its nearest named ancestor (or itself)
+  enum : uint8_t { OPEN, ACTIVE, DONE };
+  std::vector<uint8_t> state(compounds.size(), OPEN);
+  std::vector<const std::string*> prefix(compounds.size(), nullptr);
+  std::vector<CompoundStore::Index> path;
+  for(CompoundStore::Index i=0; i<compounds.size(); ++i) {
+    path.clear();
+    auto index = i;
+    while(index != CompoundStore::NONE && state[index] == OPEN) {
+      state[index] = ACTIVE;
+      path.push_back(index);
+      auto& pid = compounds[index].parentId;
+      index = pid.empty() ? CompoundStore::NONE : compounds.find(pid);
+      if(index != CompoundStore::NONE)
+        index = compounds.resolve(index);
+    }
+    const std::string* parentPrefix = nullptr;
+    if(index != CompoundStore::NONE && state[index] == ACTIVE) {
+      // the last compound of the path becomes a root
+      auto& cmp = compounds[path.back()];
+      std::cerr << std::endl << "cyclic parent of " << (cmp.name.empty() ? toString(cmp.id) : cmp.name) << " at " << cmp.location << "." << std::endl;
+    } else if(index != CompoundStore::NONE) {
+      parentPrefix = prefix[index];
+    }
+    for(size_t j=path.size(); j-- > 0;) {
+      auto& cmp = compounds[path[j]];
+      if(!cmp.isRef() && !cmp.name.empty()) {
+        cmp.fullname = parentPrefix ? *parentPrefix + "." + cmp.name : cmp.name;
+        parentPrefix = &cmp.fullname;
+      }
+      prefix[path[j]] = parentPrefix;
+      state[path[j]] = DONE;
+    }
+  }
+  if(stats)
+    stats->addPhase(Statistics::RESOLVE, watch);
 }
 
 void Parser::writeJSON(const std::string& path) const {
   using namespace EScript::StringUtils;
+  resolve();
+  if(incremental) {
+    writeChangedJSON(path);
+    return;
+  }
   
   size_t maxLength = 80;
   int progress = 0;
   
-  // compute full names
-  for(auto& c : context->compounds) {
-    auto& cmp = c.second;
-    if(cmp.isRef() || cmp.name.empty())
-      continue;
-    
-    if(cmp.kind == Compound::GROUP) {
-      if(!cmp.children.empty()) {
-        cmp.parentId = getCompound(cmp.children.front().compound, context.get()).id;
-      } else if(!cmp.member.empty()) {
-        cmp.parentId = getCompound(cmp.member.front().compound, context.get()).id;
-      }
-    }
-    
-    cmp.fullname = cmp.name;
-    auto pid = cmp.parentId;
-    while(!pid.empty()) {
-      auto& p = getCompound(pid, context.get());
-      if(!p.name.empty())
-        cmp.fullname = p.name + "." + cmp.fullname;
-      pid = p.parentId;
-    }
-  }
+  auto& compounds = context->compounds;
+  computeFullnames();
   
-  for(auto& c : context->compounds) {
-    auto& cmp = c.second;
+  TraceSpan span("writeJSON");
+  Stopwatch watch;
+  JsonWriter writer;
+  for(CompoundStore::Index i=0; i<compounds.size(); ++i) {
+    auto& cmp = compounds[i];
     if(cmp.isRef() || cmp.name.empty()) {
       ++progress;
       continue;
     }
-    std::string kind = "unknown";
-    switch(cmp.kind) {
-      case Compound::NAMESPACE:
-        kind = "namespace"; break;
-      case Compound::TYPE:
-        kind = "type"; break;
-      case Compound::GROUP:
-        kind = "group"; break;
-      default: break;
-    }
-    
-    std::stringstream json;
-    std::string filename = kind + "_" + replaceAll(cmp.fullname, ".", "_") + ".json";
+    std::string filename = std::string(getKindName(cmp)) + "_" + replaceAll(cmp.fullname, ".", "_") + ".json";
       
-    int percent = static_cast<float>(progress)/context->compounds.size()*100;
+    int percent = static_cast<float>(progress)/compounds.size()*100;
     maxLength = std::max(maxLength, filename.size());
     std::cout << "\r[" << percent << "%] Writing " << filename << std::string(maxLength-filename.size(), ' ') << std::flush;
     
-    auto parent = getCompound(cmp.parentId, context.get());
-    auto group = getCompound(cmp.group, context.get());
-    auto base = getCompound(cmp.base, context.get());
-    
-    json << "{" << std::endl;
-    json << "  \"id\" : \"" << cmp.id << "\"," << std::endl;
-    json << "  \"name\" : \"" << cmp.name << "\"," << std::endl;
-    json << "  \"fullname\" : \"" << cmp.fullname << "\"," << std::endl;
-    json << "  \"kind\" : \"" << kind << "\"," << std::endl;
-    json << "  \"location\" : \"" << cmp.location << "\"," << std::endl;
-    json << "  \"parent\" : \"" << (parent.name.empty() ? "" : cmp.parentId.toString()) << "\"," << std::endl;
-    json << "  \"group\" : \"" << (group.name.empty() ? "" : cmp.group.toString()) << "\"," << std::endl;
-    json << "  \"base\" : \"" << (base.name.empty() ? "" : cmp.base.toString()) << "\"," << std::endl;
-    json << "  \"description\" : \"" << escape(cmp.decription) << "\"," << std::endl;    
-    json << "  \"children\" : [" << std::endl;
-    for(auto& v : cmp.children) {
-      std::string fullname = getCompound(v.compound, context.get()).fullname + "." + v.name;
-      json << "    {" << std::endl;
-      json << "      \"name\" : \"" << v.name << "\"," << std::endl;
-      json << "      \"fullname\" : \"" << fullname << "\"," << std::endl;
-      json << "      \"ref\" : \"" << v.ref << "\"," << std::endl;
-      json << "      \"location\" : \"" << v.location << "\"," << std::endl;
-      json << "    }," << std::endl;
-    }
-    json << "  ]," << std::endl;
-    
-    json << "  \"member\" : [" << std::endl;
-    for(auto& v : cmp.member) {      
-      std::string kind = "unknown";
-      switch(v.kind) {
-        case Member::CONST:
-          kind = "const"; break;
-        case Member::FUNCTION:
-          kind = "function"; break;
-        default: break;
-      }
-      std::string fullname = getCompound(v.compound, context.get()).fullname + "." + v.name;
-      json << "    {" << std::endl;
-      json << "      \"name\" : \"" << v.name << "\"," << std::endl;
-      json << "      \"fullname\" : \"" << fullname << "\"," << std::endl;
-      json << "      \"kind\" : \"" << kind << "\"," << std::endl;
-      json << "      \"minParams\" : " << v.minParams << "," <<std::endl;
-      json << "      \"maxParams\" : " << v.maxParams << "," << std::endl;
-      json << "      \"location\" : \"" << v.location << "\"," << std::endl;
-      json << "      \"description\" : \"" << escape(v.description) << "\"," << std::endl;
-      json << "      \"cpp\" : \"" << v.cppRef << "\"," << std::endl;
-      json << "      \"group\" : \"" << v.group << "\"," << std::endl;
-      json << "      \"deprecated\" : " << (v.deprecated ? "true" : "false") << "," << std::endl;
-      json << "    }," << std::endl;
-    }
-    json << "  ]," << std::endl;
-    json << "}" << std::endl;
-    
-    EScript::IO::saveFile(path + "/" + filename, json.str());
+    if(!writer.open(path + "/" + filename)) {
+      std::cerr << std::endl << "could not open " << path << "/" << filename << "." << std::endl;
+      ++progress;
+      continue;
+    }
+    writeCompoundJSON(writer, cmp, context.get());
+    if(!writer.close())
+      std::cerr << std::endl << "could not write " << path << "/" << filename << "." << std::endl;
     ++progress;
   }
   std::cout << std::endl << "[100%] Finished writing json" << std::endl;
+  if(stats)
+    stats->addPhase(Statistics::WRITE, watch);
+}
+
+void Parser::writeChangedJSON(const std::string& path) const {
+  using namespace EScript::StringUtils;
+  auto& compounds = context->compounds;
+  computeFullnames();
+  
+  TraceSpan span("writeJSON");
+  Stopwatch watch;
+  JsonWriter writer;
+  std::string document;
+  std::unordered_map<std::string, uint64_t> documents;
+  size_t count = 0;
+  for(CompoundStore::Index i=0; i<compounds.size(); ++i) {
+    auto& cmp = compounds[i];
+    if(cmp.isRef() || cmp.name.empty())
+      continue;
+    std::string filename = std::string(getKindName(cmp)) + "_" + replaceAll(cmp.fullname, ".", "_") + ".json";
+    document.clear();
+    writer.open(document);
+    writeCompoundJSON(writer, cmp, context.get());
+    writer.close();
+    uint64_t hash = hashData(document.data(), document.size());
+    documents[filename] = hash;
+    auto it = incremental->documents.find(filename);
+    if(it != incremental->documents.end() && it->second == hash)
+      continue;
+    std::ofstream out(path + "/" + filename, std::ios::binary | std::ios::trunc);
+    out.write(document.data(), document.size());
+    if(!out) {
+      std::cerr << std::endl << "could not write " << path << "/" << filename << "." << std::endl;
+      documents.erase(filename);
+      continue;
+    }
+    ++count;
+  }
+  // documents of compounds that do not exist anymore
+  size_t removed = 0;
+  for(auto& v : incremental->documents) {
+    if(documents.find(v.first) == documents.end() && std::remove((path + "/" + v.first).c_str()) == 0)
+      ++removed;
+  }
+  incremental->documents = std::move(documents);
+  std::cout << "Updated " << count << " of " << incremental->documents.size() << " documents";
+  if(removed > 0)
+    std::cout << ", removed " << removed;
+  std::cout << std::endl;
+  if(stats)
+    stats->addPhase(Statistics::WRITE, watch);
+}
+
+Model Parser::getModel() const {
+  resolve();
+  computeFullnames();
+  return Model(context.get());
+}
+
+void Parser::writeBundle(const std::string& file) const {
+  resolve();
+  computeFullnames();
+  TraceSpan span("writeBundle");
+  Stopwatch watch;
+  std::cout << "Writing " << file << std::flush;
+  if(WhatsUpDoc::writeBundle(file, context.get()))
+    std::cout << std::endl << "[100%] Finished writing bundle" << std::endl;
+  else
+    std::cerr << std::endl << "could not write " << file << "." << std::endl;
+  if(stats)
+    stats->addPhase(Statistics::WRITE, watch);
 }
 
-} /* WhatsUpDoc */
\ No newline at end of file
+} /* WhatsUpDoc */
@@ -1,27 +1,86 @@
 #ifndef WHATSUPDOC_PARSER_H_
 #define WHATSUPDOC_PARSER_H_
 
+#include "Model.h"
+
 #include <string>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <unordered_map>
 
 namespace WhatsUpDoc {
 struct ParsingContext;
+class ResultCache;
+struct SourceScope;
+class HeaderRegistry;
+class Statistics;
+struct IncrementalState;
 
 class Parser {
 public:
+  typedef std::function<void(const std::string& filename, size_t index)> ProgressCallback;
+  
   Parser();
   ~Parser();
   
   void addInclude(const std::string& path);
   void addDefinition(const std::string& def);
   void addFlag(const std::string& flag);
+  bool loadCompilationDatabase(const std::string& buildDir, std::vector<std::string>* files=nullptr);
+  void setCacheDir(const std::string& path);
+  void setScope(const std::vector<std::string>& include, const std::vector<std::string>& exclude);
+  bool usePrecompiledHeader(const std::vector<std::string>& headers, const std::string& pchFile);
+  size_t getCacheHits() const;
+  // collects timing statistics of the following runs
+  void enableStatistics();
+  Statistics* getStatistics() const { return stats.get(); }
+  // keeps the translation units of the following runs alive for update()
+  void enableIncremental();
+  // content that is used instead of the file on disk (also for included files), disables the cache
+  void addUnsavedFile(const std::string& filename, const std::string& content);
+  // the init hierarchy of single files is resolved once before the model is used
   void parseFile(const std::string& filename);
+  void parseBuffer(const std::string& filename, const std::string& content);
+  // writes the unresolved results of a file including all of its in-scope headers (for linkFiles)
+  bool compileFile(const std::string& filename, const std::string& artifact);
+  // merges compiled files, the same order as for parseFiles results in the same model
+  bool linkFiles(const std::vector<std::string>& artifacts);
+  void parseFiles(const std::vector<std::string>& files, unsigned int threads=1, const ProgressCallback& progress=nullptr);
+  // reparses only the files depending on one of the changed files, the model is then rebuilt
+  // from the stored results of all files (merging is order dependent and can not be undone
+  // per file), returns the number of reparsed files
+  size_t update(const std::vector<std::string>& changedFiles);
+  // real paths of the parsed files & their in-scope includes (incremental mode only)
+  std::vector<std::string> getDependencies() const;
+  // in incremental mode only documents with a changed content are written
   void writeJSON(const std::string& path) const;
+  // resolved compounds, valid until files are parsed or updated
+  Model getModel() const;
+  // writes all documents into a single indexed file (see Bundle.h)
+  void writeBundle(const std::string& file) const;
 private:
+  void mergeFile(const std::string& filename);
+  void resolve() const;
+  void computeFullnames() const;
+  void rebuild() const;
+  void writeChangedJSON(const std::string& path) const;
+  const std::vector<std::string>& getArgs(const std::string& filename) const;
+  
   std::vector<std::string> include;
   std::vector<std::string> define;
+  std::vector<std::string> flags;
+  std::unordered_map<std::string, std::vector<std::string>> fileArgs;
+  std::unordered_map<std::string, std::string> unsavedFiles;
+  std::string pch;
   std::unique_ptr<ParsingContext> context;
+  std::unique_ptr<ResultCache> cache;
+  std::unique_ptr<SourceScope> scope;
+  std::unique_ptr<HeaderRegistry> headers;
+  std::unique_ptr<Statistics> stats;
+  std::unique_ptr<IncrementalState> incremental;
+  // false if files were merged since the init hierarchy was resolved
+  mutable bool resolved = true;
 };
 
 } /* WhatsUpDoc */
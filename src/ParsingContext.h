@@ -0,0 +1,224 @@
+#ifndef WHATSUPDOC_PARSINGCONTEXT_H_
+#define WHATSUPDOC_PARSINGCONTEXT_H_
+
+#include "Helper.h"
+#include "CommentParser.h"
+#include "TokenIndex.h"
+#include "AstIndex.h"
+
+#include <clang-c/Index.h>
+#include <EScript/Utils/StringId.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+
+struct Member {
+  std::string name;
+  enum {UNKNOWN, FUNCTION, CONST} kind = UNKNOWN;
+  EScript::StringId compound;
+  Location location;
+  std::string description;
+  std::string cppRef;
+  std::string group;
+  int minParams = 0;
+  int maxParams = 0;
+  bool deprecated = false;
+};
+
+struct Reference {
+  std::string name;
+  EScript::StringId compound;
+  Location location;
+  EScript::StringId ref;
+};
+
+// index of a member or reference in the pool of its context
+typedef uint32_t MemberHandle;
+typedef uint32_t ReferenceHandle;
+
+struct InitCall {
+  EScript::StringId id;
+  EScript::StringId lib;
+  EScript::StringId group;
+};
+
+struct Compound {
+  EScript::StringId id;
+  EScript::StringId refId;
+  EScript::StringId parentId;
+  EScript::StringId group;
+  EScript::StringId base;
+  std::string name;
+  std::string fullname;
+  std::string decription;
+  Location location;
+  enum {UNKNOWN, NAMESPACE, TYPE, GROUP} kind = UNKNOWN;
+  // owned by the compound, groups refer to the entries of other compounds
+  std::vector<MemberHandle> member;
+  std::vector<ReferenceHandle> children;
+  bool isNull() const { return id.empty(); }
+  bool isRef() const { return !refId.empty(); }
+};
+
+struct InitFunction {
+  EScript::StringId id;
+  EScript::StringId paramId;
+  Location location;
+};
+
+// entry declared on the parameter of an init function without a group, it inherits
+// the group of the init call once all files are merged (see resolveInitCalls)
+struct PendingGroupEntry {
+  EScript::StringId init;
+  enum {MEMBER, CHILD} kind = MEMBER;
+  // member or child handle depending on the kind
+  uint32_t handle = 0;
+};
+
+// path prefixes of the files that are visited
+struct SourceScope {
+  std::vector<std::string> include;
+  std::vector<std::string> exclude;
+  bool contains(const std::string& path) const;
+};
+
+// identifies a header file (hash of the real path) parsed with a specific set of compiler arguments
+// & macros defined by the including file before the inclusion
+struct HeaderKey {
+  uint64_t file;
+  uint64_t args;
+  bool operator==(const HeaderKey& other) const { return file == other.file && args == other.args; }
+};
+
+struct HeaderKeyHash {
+  size_t operator()(const HeaderKey& key) const {
+    return std::hash<uint64_t>()(key.file ^ (key.args * 1099511628211ull));
+  }
+};
+
+/**
+ * Compounds of a context, stored densely in insertion order. Ids are interned to
+ * 32 bit indices once, compounds merged into others (aliases) are resolved by
+ * union-find with path compression. References to compounds stay valid on insertion.
+ */
+class CompoundStore {
+public:
+  typedef uint32_t Index;
+  static const Index NONE = 0xffffffffu;
+  
+  size_t size() const { return compounds.size(); }
+  void clear();
+  // index of the entry for the id or NONE
+  Index find(const EScript::StringId& id) const;
+  // index of the entry for the id, an empty entry is added if necessary
+  Index insert(const EScript::StringId& id);
+  // index of the compound the entry was merged into (the entry itself if it is no alias)
+  Index resolve(Index index) const;
+  // marks the entry of alias as merged into the compound of target
+  void setAlias(const EScript::StringId& alias, const EScript::StringId& target);
+  // indices ordered by id
+  std::vector<Index> getSortedIndices() const;
+  
+  const EScript::StringId& getId(Index index) const { return ids[index]; }
+  Compound& operator[](Index index) { return compounds[index]; }
+  const Compound& operator[](Index index) const { return compounds[index]; }
+  // entry for the id without resolving aliases, an empty entry is added if necessary
+  Compound& at(const EScript::StringId& id) { return compounds[insert(id)]; }
+private:
+  std::deque<Compound> compounds;
+  std::vector<EScript::StringId> ids;
+  mutable std::vector<Index> parents;
+  std::unordered_map<EScript::StringId, Index> indices;
+};
+
+class HeaderRegistry;
+struct FileStats;
+struct ParsingContext;
+
+// compound for the id (or the one it was merged into), an empty compound if there is none
+const Compound& findCompound(const EScript::StringId& id, const ParsingContext* context);
+
+struct ParsingContext {
+  CXIndex index = nullptr;
+  CXTranslationUnit tu = nullptr;
+  // token & cursor indices of the translation unit while it is visited
+  TokenIndex* tokens = nullptr;
+  AstIndex* ast = nullptr;
+  // statistics of the translation unit (optional)
+  FileStats* stats = nullptr;
+  const SourceScope* scope = nullptr;
+  HeaderRegistry* headers = nullptr;
+  // position of the file in the input of the registry, the results of shared headers are taken from the first file
+  size_t inputIndex = 0;
+  // in-memory contents of files (optional)
+  const std::vector<CXUnsavedFile>* unsavedFiles = nullptr;
+  uint64_t argsHash = 0;
+  // target context for the declarations of each file (nullptr if skipped)
+  std::unordered_map<CXFile, ParsingContext*> fileTargets;
+  // hash of the macro directives of the main file preceding the inclusion of each file (see getIncludeDefines)
+  std::unordered_map<CXFile, uint64_t> includeDefines;
+  bool includeDefinesValid = false;
+  // in-scope headers included by the translation unit & the results of the visited ones
+  std::vector<HeaderKey> includedHeaders;
+  std::vector<std::pair<HeaderKey, std::unique_ptr<ParsingContext>>> headerFragments;
+  InitFunction activeInit;
+  EScript::StringId activeGroup;
+  bool groupBlock = false;
+  EScript::StringId activeMemberGroup;
+  bool memberGroupBlock = false;
+  bool deprecated = false; 
+  //std::unordered_map<EScript::StringId, InitFunction> inits;
+  std::unordered_map<EScript::StringId, std::string> names;
+  CommentBuffer comments;
+  CompoundStore compounds;
+  // members & references of all compounds, groups share them with their owners
+  std::deque<Member> members;
+  std::deque<Reference> references;
+  // raw facts of the init hierarchy, resolved after merging all files
+  std::unordered_map<EScript::StringId, InitCall> initCalls;
+  std::vector<PendingGroupEntry> pendingGroups;
+};
+
+/**
+ * Shared between all translation units of a run: each header is only visited
+ * by the first translation unit that claims it, the results are merged once.
+ * If several units publish the results of a header, the ones of the unit with
+ * the lowest input index are kept (independent of the thread timing).
+ */
+class HeaderRegistry {
+public:
+  HeaderRegistry(bool skipClaimed=true) : skipClaimed(skipClaimed) {}
+  // input indices for the next count files, returns the first one
+  size_t addFiles(size_t count);
+  // returns true if the header should be visited by the caller
+  bool claim(const HeaderKey& key);
+  void publish(const HeaderKey& key, std::unique_ptr<ParsingContext> fragment, size_t inputIndex);
+  // waits until the results of the header are published, returns nullptr if they were already taken
+  std::unique_ptr<ParsingContext> take(const HeaderKey& key);
+  void setSkipClaimed(bool value) { skipClaimed = value; }
+private:
+  struct Entry {
+    bool claimed = false;
+    bool published = false;
+    bool taken = false;
+    size_t inputIndex = 0;
+    std::unique_ptr<ParsingContext> fragment;
+  };
+  bool skipClaimed;
+  size_t fileCount = 0;
+  std::mutex mutex;
+  std::condition_variable published;
+  std::unordered_map<HeaderKey, Entry, HeaderKeyHash> entries;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_PARSINGCONTEXT_H_ */
@@ -0,0 +1,133 @@
+#include "ResultCache.h"
+#include "ParsingContext.h"
+#include "Serialization.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+
+namespace WhatsUpDoc {
+
+static const char* CACHE_MAGIC = "WUDC";
+static const uint64_t CACHE_VERSION = 5;
+
+// -------------------------------------------------
+
+uint64_t hashData(const char* data, size_t size, uint64_t hash) {
+  // FNV-1a
+  for(size_t i=0; i<size; ++i) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// -------------------------------------------------
+
+uint64_t hashFile(const std::string& filename) {
+  std::ifstream in(filename, std::ios::binary);
+  if(!in)
+    return 0;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  auto content = ss.str();
+  return hashData(content.data(), content.size());
+}
+
+// -------------------------------------------------
+
+ResultCache::ResultCache(const std::string& path) : path(path), hits(0), misses(0) {}
+
+// -------------------------------------------------
+
+uint64_t ResultCache::getFileHash(const std::string& filename) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = fileHashes.find(filename);
+    if(it != fileHashes.end())
+      return it->second;
+  }
+  uint64_t hash = hashFile(filename);
+  std::lock_guard<std::mutex> lock(mutex);
+  fileHashes[filename] = hash;
+  return hash;
+}
+
+// -------------------------------------------------
+
+std::string ResultCache::getEntryPath(const std::string& filename, const std::string& args) const {
+  uint64_t hash = hashData(filename.data(), filename.size());
+  hash = hashData(args.data(), args.size(), hash);
+  std::stringstream ss;
+  ss << path << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".wuc";
+  return ss.str();
+}
+
+// -------------------------------------------------
+
+bool ResultCache::load(const std::string& filename, const std::string& args, ParsingContext* context) {
+  std::ifstream in(getEntryPath(filename, args), std::ios::binary);
+  if(!in) {
+    ++misses;
+    return false;
+  }
+  BinaryReader reader(in);
+  bool valid = reader.readString() == CACHE_MAGIC && reader.readUInt() == CACHE_VERSION;
+  valid = valid && reader.readString() == filename && reader.readString() == args;
+  valid = valid && reader.readUInt() == getFileHash(filename);
+  uint64_t includeCount = valid ? reader.readUInt() : 0;
+  for(uint64_t i=0; i<includeCount && valid; ++i) {
+    auto include = reader.readString();
+    valid = reader.good() && reader.readUInt() == getFileHash(include);
+  }
+  if(!valid || !readContext(reader, context)) {
+    // discard partially loaded results
+    context->compounds.clear();
+    context->members.clear();
+    context->references.clear();
+    context->initCalls.clear();
+    context->names.clear();
+    context->pendingGroups.clear();
+    context->includedHeaders.clear();
+    context->headerFragments.clear();
+    ++misses;
+    return false;
+  }
+  ++hits;
+  return true;
+}
+
+// -------------------------------------------------
+
+void ResultCache::store(const std::string& filename, const std::string& args, const std::vector<std::string>& includes, const ParsingContext* context) {
+  auto entryPath = getEntryPath(filename, args);
+  // write to a temporary file first, so that concurrent runs never see partial entries
+  auto tmpPath = getTempPath(entryPath);
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if(!out)
+      return;
+    BinaryWriter writer(out);
+    writer.writeString(CACHE_MAGIC);
+    writer.writeUInt(CACHE_VERSION);
+    writer.writeString(filename);
+    writer.writeString(args);
+    writer.writeUInt(getFileHash(filename));
+    writer.writeUInt(includes.size());
+    for(auto& include : includes) {
+      writer.writeString(include);
+      writer.writeUInt(getFileHash(include));
+    }
+    writeContext(writer, context);
+    if(!out.good()) {
+      out.close();
+      std::remove(tmpPath.c_str());
+      return;
+    }
+  }
+  if(std::rename(tmpPath.c_str(), entryPath.c_str()) != 0)
+    std::remove(tmpPath.c_str());
+}
+
+} /* WhatsUpDoc */
@@ -0,0 +1,44 @@
+#ifndef WHATSUPDOC_RESULTCACHE_H_
+#define WHATSUPDOC_RESULTCACHE_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+struct ParsingContext;
+
+/**
+ * Persistent cache of the extraction results of single translation units.
+ * Entries are stored per file & compiler arguments and are only valid as long as 
+ * the content of the file and all of its (transitive) includes is unchanged.
+ */
+class ResultCache {
+public:
+  ResultCache(const std::string& path);
+  
+  bool load(const std::string& filename, const std::string& args, ParsingContext* context);
+  void store(const std::string& filename, const std::string& args, const std::vector<std::string>& includes, const ParsingContext* context);
+  
+  size_t getHits() const { return hits; }
+  size_t getMisses() const { return misses; }
+private:
+  uint64_t getFileHash(const std::string& filename);
+  std::string getEntryPath(const std::string& filename, const std::string& args) const;
+  
+  std::string path;
+  std::mutex mutex;
+  std::unordered_map<std::string, uint64_t> fileHashes;
+  std::atomic<size_t> hits;
+  std::atomic<size_t> misses;
+};
+
+uint64_t hashData(const char* data, size_t size, uint64_t hash=14695981039346656037ull);
+uint64_t hashFile(const std::string& filename);
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_RESULTCACHE_H_ */
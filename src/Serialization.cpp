@@ -0,0 +1,358 @@
+#include "Serialization.h"
+#include "ParsingContext.h"
+
+#include <fstream>
+#include <cstdio>
+
+namespace WhatsUpDoc {
+using namespace EScript;
+
+static const char* ARTIFACT_MAGIC = "WUDO";
+// has to be increased together with the cache version if the context format changes
+static const uint64_t ARTIFACT_VERSION = 3;
+
+// -------------------------------------------------
+
+void BinaryWriter::writeUInt(uint64_t value) {
+  // LEB128
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    if(value != 0)
+      byte |= 0x80;
+    out.put(static_cast<char>(byte));
+  } while(value != 0);
+}
+
+void BinaryWriter::writeInt(int64_t value) {
+  // zig-zag encoding
+  writeUInt((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void BinaryWriter::writeString(const std::string& value) {
+  writeUInt(value.size());
+  out.write(value.data(), value.size());
+}
+
+// -------------------------------------------------
+
+uint64_t BinaryReader::readUInt() {
+  uint64_t value = 0;
+  for(int shift = 0; shift < 64; shift += 7) {
+    int byte = in.get();
+    if(byte == std::char_traits<char>::eof()) {
+      valid = false;
+      return 0;
+    }
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if((byte & 0x80) == 0)
+      return value;
+  }
+  valid = false;
+  return 0;
+}
+
+int64_t BinaryReader::readInt() {
+  uint64_t value = readUInt();
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+std::string BinaryReader::readString() {
+  uint64_t size = readUInt();
+  if(!good() || size > (1u << 30)) {
+    valid = false;
+    return std::string();
+  }
+  std::string value(size, '\0');
+  if(size > 0)
+    in.read(&value[0], size);
+  return value;
+}
+
+// -------------------------------------------------
+
+static void writeId(BinaryWriter& writer, const StringId& id) {
+  writer.writeString(id.empty() ? std::string() : toString(id));
+}
+
+static StringId readId(BinaryReader& reader) {
+  return toStringId(reader.readString());
+}
+
+static void writeLocation(BinaryWriter& writer, const Location& loc) {
+  writer.writeString(loc.file);
+  writer.writeUInt(loc.line);
+  writer.writeUInt(loc.col);
+}
+
+static Location readLocation(BinaryReader& reader) {
+  Location loc;
+  loc.file = reader.readString();
+  loc.line = static_cast<unsigned int>(reader.readUInt());
+  loc.col = static_cast<unsigned int>(reader.readUInt());
+  return loc;
+}
+
+static void writeMember(BinaryWriter& writer, const Member& member) {
+  writer.writeString(member.name);
+  writer.writeUInt(member.kind);
+  writeId(writer, member.compound);
+  writeLocation(writer, member.location);
+  writer.writeString(member.description);
+  writer.writeString(member.cppRef);
+  writer.writeString(member.group);
+  writer.writeInt(member.minParams);
+  writer.writeInt(member.maxParams);
+  writer.writeUInt(member.deprecated ? 1 : 0);
+}
+
+static Member readMember(BinaryReader& reader) {
+  Member member;
+  member.name = reader.readString();
+  auto kind = reader.readUInt();
+  member.kind = kind == Member::FUNCTION ? Member::FUNCTION : kind == Member::CONST ? Member::CONST : Member::UNKNOWN;
+  member.compound = readId(reader);
+  member.location = readLocation(reader);
+  member.description = reader.readString();
+  member.cppRef = reader.readString();
+  member.group = reader.readString();
+  member.minParams = static_cast<int>(reader.readInt());
+  member.maxParams = static_cast<int>(reader.readInt());
+  member.deprecated = reader.readUInt() != 0;
+  return member;
+}
+
+static void writeReference(BinaryWriter& writer, const Reference& ref) {
+  writer.writeString(ref.name);
+  writeId(writer, ref.compound);
+  writeLocation(writer, ref.location);
+  writeId(writer, ref.ref);
+}
+
+static Reference readReference(BinaryReader& reader) {
+  Reference ref;
+  ref.name = reader.readString();
+  ref.compound = readId(reader);
+  ref.location = readLocation(reader);
+  ref.ref = readId(reader);
+  return ref;
+}
+
+static void writeCompound(BinaryWriter& writer, const Compound& cmp) {
+  writeId(writer, cmp.id);
+  writeId(writer, cmp.refId);
+  writeId(writer, cmp.parentId);
+  writeId(writer, cmp.group);
+  writeId(writer, cmp.base);
+  writer.writeString(cmp.name);
+  writer.writeString(cmp.decription);
+  writeLocation(writer, cmp.location);
+  writer.writeUInt(cmp.kind);
+  writer.writeUInt(cmp.member.size());
+  for(auto h : cmp.member)
+    writer.writeUInt(h);
+  writer.writeUInt(cmp.children.size());
+  for(auto h : cmp.children)
+    writer.writeUInt(h);
+}
+
+static Compound readCompound(BinaryReader& reader) {
+  Compound cmp;
+  cmp.id = readId(reader);
+  cmp.refId = readId(reader);
+  cmp.parentId = readId(reader);
+  cmp.group = readId(reader);
+  cmp.base = readId(reader);
+  cmp.name = reader.readString();
+  cmp.decription = reader.readString();
+  cmp.location = readLocation(reader);
+  switch(reader.readUInt()) {
+    case Compound::NAMESPACE: cmp.kind = Compound::NAMESPACE; break;
+    case Compound::TYPE: cmp.kind = Compound::TYPE; break;
+    case Compound::GROUP: cmp.kind = Compound::GROUP; break;
+    default: cmp.kind = Compound::UNKNOWN; break;
+  }
+  uint64_t count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i)
+    cmp.member.emplace_back(static_cast<MemberHandle>(reader.readUInt()));
+  count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i)
+    cmp.children.emplace_back(static_cast<ReferenceHandle>(reader.readUInt()));
+  return cmp;
+}
+
+// a damaged file must not produce handles outside of the pools
+static bool validHandles(const Compound& cmp, const ParsingContext* context) {
+  for(auto h : cmp.member)
+    if(h >= context->members.size())
+      return false;
+  for(auto h : cmp.children)
+    if(h >= context->references.size())
+      return false;
+  return true;
+}
+
+// -------------------------------------------------
+
+void writeContext(BinaryWriter& writer, const ParsingContext* context) {
+  writer.writeUInt(context->members.size());
+  for(auto& m : context->members)
+    writeMember(writer, m);
+  writer.writeUInt(context->references.size());
+  for(auto& r : context->references)
+    writeReference(writer, r);
+  
+  auto& compounds = context->compounds;
+  writer.writeUInt(compounds.size());
+  for(CompoundStore::Index i=0; i<compounds.size(); ++i) {
+    writeId(writer, compounds.getId(i));
+    writeCompound(writer, compounds[i]);
+  }
+  
+  writer.writeUInt(context->initCalls.size());
+  for(auto& v : context->initCalls) {
+    writeId(writer, v.first);
+    writeId(writer, v.second.id);
+    writeId(writer, v.second.lib);
+    writeId(writer, v.second.group);
+  }
+  
+  writer.writeUInt(context->names.size());
+  for(auto& v : context->names) {
+    writeId(writer, v.first);
+    writer.writeString(v.second);
+  }
+  
+  writer.writeUInt(context->pendingGroups.size());
+  for(auto& entry : context->pendingGroups) {
+    writeId(writer, entry.init);
+    writer.writeUInt(entry.kind);
+    writer.writeUInt(entry.handle);
+  }
+  
+  writer.writeUInt(context->includedHeaders.size());
+  for(auto& key : context->includedHeaders) {
+    writer.writeUInt(key.file);
+    writer.writeUInt(key.args);
+  }
+  
+  writer.writeUInt(context->headerFragments.size());
+  for(auto& v : context->headerFragments) {
+    writer.writeUInt(v.first.file);
+    writer.writeUInt(v.first.args);
+    writeContext(writer, v.second.get());
+  }
+}
+
+// -------------------------------------------------
+
+bool readContext(BinaryReader& reader, ParsingContext* context) {
+  uint64_t count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i)
+    context->members.emplace_back(readMember(reader));
+  count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i)
+    context->references.emplace_back(readReference(reader));
+  
+  count = reader.readUInt();
+  std::vector<StringId> aliases;
+  for(uint64_t i=0; i<count && reader.good(); ++i) {
+    StringId id = readId(reader);
+    auto& cmp = context->compounds.at(id);
+    cmp = readCompound(reader);
+    if(!validHandles(cmp, context))
+      return false;
+    if(cmp.isRef())
+      aliases.emplace_back(id);
+  }
+  for(auto& id : aliases)
+    context->compounds.setAlias(id, context->compounds.at(id).refId);
+  
+  count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i) {
+    StringId key = readId(reader);
+    InitCall call;
+    call.id = readId(reader);
+    call.lib = readId(reader);
+    call.group = readId(reader);
+    context->initCalls[key] = call;
+  }
+  
+  count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i) {
+    StringId key = readId(reader);
+    context->names[key] = reader.readString();
+  }
+  
+  count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i) {
+    PendingGroupEntry entry;
+    entry.init = readId(reader);
+    if(reader.readUInt() == PendingGroupEntry::CHILD)
+      entry.kind = PendingGroupEntry::CHILD;
+    entry.handle = static_cast<uint32_t>(reader.readUInt());
+    if(entry.handle >= (entry.kind == PendingGroupEntry::CHILD ? context->references.size() : context->members.size()))
+      return false;
+    context->pendingGroups.emplace_back(std::move(entry));
+  }
+  
+  count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i) {
+    HeaderKey key;
+    key.file = reader.readUInt();
+    key.args = reader.readUInt();
+    context->includedHeaders.emplace_back(key);
+  }
+  
+  count = reader.readUInt();
+  for(uint64_t i=0; i<count && reader.good(); ++i) {
+    HeaderKey key;
+    key.file = reader.readUInt();
+    key.args = reader.readUInt();
+    std::unique_ptr<ParsingContext> fragment(new ParsingContext);
+    if(!readContext(reader, fragment.get()))
+      return false;
+    context->headerFragments.emplace_back(key, std::move(fragment));
+  }
+  return reader.good();
+}
+
+// -------------------------------------------------
+
+bool writeArtifact(const std::string& path, const std::string& source, const ParsingContext* context) {
+  // build tools must never see partially written artifacts
+  auto tmpPath = getTempPath(path);
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if(!out)
+      return false;
+    BinaryWriter writer(out);
+    writer.writeString(ARTIFACT_MAGIC);
+    writer.writeUInt(ARTIFACT_VERSION);
+    writer.writeString(source);
+    writeContext(writer, context);
+    if(!out.good()) {
+      out.close();
+      std::remove(tmpPath.c_str());
+      return false;
+    }
+  }
+  if(std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool readArtifact(const std::string& path, std::string& source, ParsingContext* context) {
+  std::ifstream in(path, std::ios::binary);
+  if(!in)
+    return false;
+  BinaryReader reader(in);
+  if(reader.readString() != ARTIFACT_MAGIC || reader.readUInt() != ARTIFACT_VERSION)
+    return false;
+  source = reader.readString();
+  return reader.good() && readContext(reader, context);
+}
+
+} /* WhatsUpDoc */
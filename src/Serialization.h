@@ -0,0 +1,44 @@
+#ifndef WHATSUPDOC_SERIALIZATION_H_
+#define WHATSUPDOC_SERIALIZATION_H_
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+struct ParsingContext;
+
+class BinaryWriter {
+public:
+  BinaryWriter(std::ostream& out) : out(out) {}
+  void writeUInt(uint64_t value);
+  void writeInt(int64_t value);
+  void writeString(const std::string& value);
+private:
+  std::ostream& out;
+};
+
+class BinaryReader {
+public:
+  BinaryReader(std::istream& in) : in(in) {}
+  uint64_t readUInt();
+  int64_t readInt();
+  std::string readString();
+  bool good() const { return valid && in.good(); }
+private:
+  std::istream& in;
+  bool valid = true;
+};
+
+// writes the extraction results of a context (compounds, init calls, names & pending groups)
+void writeContext(BinaryWriter& writer, const ParsingContext* context);
+bool readContext(BinaryReader& reader, ParsingContext* context);
+
+// compiled results of a single translation unit (see Parser::compileFile)
+bool writeArtifact(const std::string& path, const std::string& source, const ParsingContext* context);
+bool readArtifact(const std::string& path, std::string& source, ParsingContext* context);
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_SERIALIZATION_H_ */
@@ -0,0 +1,154 @@
+#include "Statistics.h"
+#include "JsonWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace WhatsUpDoc {
+
+static const char* PHASE_NAMES[Statistics::PHASE_COUNT] = {"discovery", "parse", "visit", "resolve", "write"};
+
+// -------------------------------------------------
+
+static double getThreadCpuTime() {
+#if !defined(_WIN32) && defined(CLOCK_THREAD_CPUTIME_ID)
+  timespec ts;
+  if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+void Stopwatch::reset() {
+  wallStart = std::chrono::steady_clock::now();
+  cpuStart = getThreadCpuTime();
+}
+
+double Stopwatch::getWallTime() const {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+}
+
+double Stopwatch::getCpuTime() const {
+  return getThreadCpuTime() - cpuStart;
+}
+
+// -------------------------------------------------
+
+void Statistics::addPhase(Phase phase, const Stopwatch& watch) {
+  wall[phase] += watch.getWallTime();
+  cpu[phase] += watch.getCpuTime();
+}
+
+FileStats* Statistics::addFiles(const std::vector<std::string>& names) {
+  size_t first = files.size();
+  files.resize(first + names.size());
+  for(size_t i=0; i<names.size(); ++i)
+    files[first + i].file = names[i];
+  return files.data() + first;
+}
+
+// -------------------------------------------------
+
+static void writeTime(JsonWriter& writer, const char* key, double wall, double cpu, const char* wallKey="wall") {
+  writer.key(key);
+  writer.beginObject();
+  writer.key(wallKey);
+  writer.real(wall);
+  writer.key("cpu");
+  writer.real(cpu);
+  writer.endObject();
+}
+
+bool Statistics::write(const std::string& path, size_t top) const {
+  double phaseWall[PHASE_COUNT], phaseCpu[PHASE_COUNT];
+  std::copy(wall, wall + PHASE_COUNT, phaseWall);
+  std::copy(cpu, cpu + PHASE_COUNT, phaseCpu);
+  uint64_t tokens = 0, functions = 0, constants = 0, initCalls = 0, cached = 0;
+  for(auto& f : files) {
+    phaseWall[PARSE] += f.parse;
+    phaseCpu[PARSE] += f.parseCpu;
+    phaseWall[VISIT] += f.visit;
+    phaseCpu[VISIT] += f.visitCpu;
+    tokens += f.tokens;
+    functions += f.functions;
+    constants += f.constants;
+    initCalls += f.initCalls;
+    cached += f.cached ? 1 : 0;
+  }
+  
+  JsonWriter writer;
+  if(!writer.open(path))
+    return false;
+  writer.beginObject();
+  writer.key("phases");
+  writer.beginObject();
+  // parse & visit are summed over the files of all threads, they are no elapsed time
+  for(int i=0; i<PHASE_COUNT; ++i)
+    writeTime(writer, PHASE_NAMES[i], phaseWall[i], phaseCpu[i], i == PARSE || i == VISIT ? "accumulated" : "wall");
+  writer.endObject();
+  
+  writer.key("totals");
+  writer.beginObject();
+  writer.key("files");
+  writer.number(files.size());
+  writer.key("cached");
+  writer.number(cached);
+  writer.key("tokens");
+  writer.number(tokens);
+  writer.key("declareFunction");
+  writer.number(functions);
+  writer.key("declareConstant");
+  writer.number(constants);
+  writer.key("initCalls");
+  writer.number(initCalls);
+  writer.endObject();
+  
+  writer.key("files");
+  writer.beginArray();
+  for(auto& f : files) {
+    writer.beginObject();
+    writer.key("file");
+    writer.value(f.file);
+    writer.key("cached");
+    writer.boolean(f.cached);
+    writeTime(writer, "parse", f.parse, f.parseCpu);
+    writeTime(writer, "visit", f.visit, f.visitCpu);
+    writer.key("comments");
+    writer.real(f.comments);
+    writer.key("tokens");
+    writer.number(f.tokens);
+    writer.key("declareFunction");
+    writer.number(f.functions);
+    writer.key("declareConstant");
+    writer.number(f.constants);
+    writer.key("initCalls");
+    writer.number(f.initCalls);
+    writer.endObject();
+  }
+  writer.endArray();
+  
+  // parse & visit time
+  std::vector<const FileStats*> slowest;
+  for(auto& f : files)
+    slowest.emplace_back(&f);
+  top = std::min(top, slowest.size());
+  std::partial_sort(slowest.begin(), slowest.begin() + top, slowest.end(), [](const FileStats* a, const FileStats* b) {
+    return a->parse + a->visit > b->parse + b->visit;
+  });
+  writer.key("slowest");
+  writer.beginArray();
+  for(size_t i=0; i<top; ++i) {
+    writer.beginObject();
+    writer.key("file");
+    writer.value(slowest[i]->file);
+    writer.key("time");
+    writer.real(slowest[i]->parse + slowest[i]->visit);
+    writer.endObject();
+  }
+  writer.endArray();
+  writer.endObject();
+  return writer.close();
+}
+
+} /* WhatsUpDoc */
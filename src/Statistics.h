@@ -0,0 +1,64 @@
+#ifndef WHATSUPDOC_STATISTICS_H_
+#define WHATSUPDOC_STATISTICS_H_
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+
+// wall time & cpu time of the calling thread in seconds
+class Stopwatch {
+public:
+  Stopwatch() { reset(); }
+  void reset();
+  double getWallTime() const;
+  double getCpuTime() const;
+private:
+  std::chrono::steady_clock::time_point wallStart;
+  double cpuStart;
+};
+
+struct FileStats {
+  std::string file;
+  bool cached = false;
+  // seconds spent in libclang, in the visitors & in the comment parser (part of visit)
+  double parse = 0;
+  double parseCpu = 0;
+  double visit = 0;
+  double visitCpu = 0;
+  double comments = 0;
+  uint64_t tokens = 0;
+  uint32_t functions = 0;
+  uint32_t constants = 0;
+  uint32_t initCalls = 0;
+};
+
+/**
+ * Timing report of a run. The parse & visit phases are the sums of the file
+ * times (over all threads) and are reported as "accumulated" instead of "wall",
+ * the other phases are measured on the main thread.
+ */
+class Statistics {
+public:
+  enum Phase { DISCOVERY, PARSE, VISIT, RESOLVE, WRITE, PHASE_COUNT };
+
+  void addPhase(Phase phase, const Stopwatch& watch);
+  // entries for the files of a run, the entries stay valid until the next call
+  FileStats* addFiles(const std::vector<std::string>& files);
+  const std::vector<FileStats>& getFiles() const { return files; }
+  double getWallTime(Phase phase) const { return wall[phase]; }
+  double getCpuTime(Phase phase) const { return cpu[phase]; }
+
+  // writes the report as json, including the top slowest files
+  bool write(const std::string& path, size_t top=10) const;
+private:
+  double wall[PHASE_COUNT] = {};
+  double cpu[PHASE_COUNT] = {};
+  std::vector<FileStats> files;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_STATISTICS_H_ */
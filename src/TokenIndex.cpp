@@ -0,0 +1,79 @@
+#include "TokenIndex.h"
+
+#include <algorithm>
+
+namespace WhatsUpDoc {
+
+// -------------------------------------------------
+
+const std::vector<TokenIndex::Token>& TokenIndex::getFileTokens(CXFile file) {
+  auto it = files.find(file);
+  if(it != files.end())
+    return it->second;
+  auto& result = files[file];
+  
+  size_t size = 0;
+  const char* contents = clang_getFileContents(tu, file, &size);
+  if(!contents)
+    return result;
+  CXSourceRange range = clang_getRange(clang_getLocationForOffset(tu, file, 0), clang_getLocationForOffset(tu, file, size));
+  CXToken *tokens = 0;
+  unsigned int nTokens = 0;
+  clang_tokenize(tu, range, &tokens, &nTokens);
+  result.reserve(nTokens);
+  for (unsigned int i = 0; i < nTokens; i++) {
+    CXSourceRange extent = clang_getTokenExtent(tu, tokens[i]);
+    unsigned int begin = 0, end = 0;
+    clang_getFileLocation(clang_getRangeStart(extent), nullptr, nullptr, nullptr, &begin);
+    clang_getFileLocation(clang_getRangeEnd(extent), nullptr, nullptr, nullptr, &end);
+    if(begin > size || end > size || end < begin)
+      continue;
+    result.push_back({clang_getTokenKind(tokens[i]), begin, end - begin, contents + begin});
+  }
+  clang_disposeTokens(tu, tokens, nTokens);
+  return result;
+}
+
+// -------------------------------------------------
+
+TokenIndex::Range TokenIndex::getTokens(CXCursor cursor) {
+  Range range;
+  CXSourceRange extent = clang_getCursorExtent(cursor);
+  CXFile file = nullptr, endFile = nullptr;
+  unsigned int begin = 0, end = 0;
+  clang_getFileLocation(clang_getRangeStart(extent), &file, nullptr, nullptr, &begin);
+  clang_getFileLocation(clang_getRangeEnd(extent), &endFile, nullptr, nullptr, &end);
+  // clang_tokenize does not return tokens for ranges spanning several files
+  if(!file || file != endFile)
+    return range;
+  auto& tokens = getFileTokens(file);
+  auto cmp = [](const Token& t, uint32_t offset) { return t.offset < offset; };
+  range.file = file;
+  range.first = std::lower_bound(tokens.data(), tokens.data() + tokens.size(), begin, cmp);
+  range.last = std::lower_bound(range.first, tokens.data() + tokens.size(), end, cmp);
+  return range;
+}
+
+// -------------------------------------------------
+
+Location TokenIndex::getLocation(CXFile file, const Token& token) const {
+  Location loc;
+  CXString filename;
+  CXSourceLocation location = clang_getLocationForOffset(tu, file, token.offset);
+  clang_getPresumedLocation(location, &filename, &loc.line, &loc.col);
+  loc.file = toString(filename);
+  return loc;
+}
+
+// -------------------------------------------------
+
+size_t TokenIndex::getTokenCount() const {
+  size_t count = 0;
+  for(auto& v : files)
+    count += v.second.size();
+  return count;
+}
+
+// -------------------------------------------------
+
+} /* WhatsUpDoc */
@@ -0,0 +1,51 @@
+#ifndef WHATSUPDOC_TOKENINDEX_H_
+#define WHATSUPDOC_TOKENINDEX_H_
+
+#include "Helper.h"
+
+#include <clang-c/Index.h>
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+
+/**
+ * Tokens of the files of a translation unit. 
+ * Each file is tokenized once when it is first accessed, the tokens are sorted
+ * by offset and their spellings point into the file contents of the translation unit.
+ */
+class TokenIndex {
+public:
+  struct Token {
+    CXTokenKind kind;
+    uint32_t offset;
+    uint32_t length;
+    const char* spelling;
+  };
+  struct Range {
+    CXFile file = nullptr;
+    const Token* first = nullptr;
+    const Token* last = nullptr;
+    const Token* begin() const { return first; }
+    const Token* end() const { return last; }
+  };
+  
+  explicit TokenIndex(CXTranslationUnit tu) : tu(tu) {}
+  
+  // tokens within the extent of the cursor
+  Range getTokens(CXCursor cursor);
+  Location getLocation(CXFile file, const Token& token) const;
+  // number of tokens of all files tokenized so far
+  size_t getTokenCount() const;
+private:
+  const std::vector<Token>& getFileTokens(CXFile file);
+  
+  CXTranslationUnit tu;
+  std::unordered_map<CXFile, std::vector<Token>> files;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_TOKENINDEX_H_ */
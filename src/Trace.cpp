@@ -0,0 +1,106 @@
+#include "Trace.h"
+#include "JsonWriter.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace WhatsUpDoc {
+
+std::atomic<bool> tracingEnabled(false);
+
+namespace {
+
+struct TraceEvent {
+  const char* name;
+  uint64_t start;
+  uint64_t duration;
+  std::string detail;
+};
+
+// events of a single thread, kept after the thread has finished
+struct TraceBuffer {
+  uint32_t tid;
+  std::vector<TraceEvent> events;
+};
+
+std::mutex bufferMutex;
+std::vector<std::unique_ptr<TraceBuffer>> buffers;
+std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+TraceBuffer& getBuffer() {
+  static thread_local TraceBuffer* buffer = nullptr;
+  if(!buffer) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    buffers.emplace_back(new TraceBuffer{static_cast<uint32_t>(buffers.size() + 1), {}});
+    buffer = buffers.back().get();
+    buffer->events.reserve(4096);
+  }
+  return *buffer;
+}
+
+} // namespace
+
+// -------------------------------------------------
+
+void enableTracing() {
+  origin = std::chrono::steady_clock::now();
+  tracingEnabled = true;
+}
+
+uint64_t TraceSpan::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void TraceSpan::finish() {
+  uint64_t end = now();
+  getBuffer().events.push_back({name, start, end - start, std::move(detail)});
+}
+
+// -------------------------------------------------
+
+bool writeTrace(const std::string& path) {
+  JsonWriter writer;
+  if(!writer.open(path))
+    return false;
+  std::lock_guard<std::mutex> lock(bufferMutex);
+  writer.beginObject();
+  writer.key("displayTimeUnit");
+  writer.value("ms", 2);
+  writer.key("traceEvents");
+  writer.beginArray();
+  for(auto& buffer : buffers) {
+    for(auto& event : buffer->events) {
+      writer.beginObject();
+      writer.key("name");
+      writer.value(event.name, std::char_traits<char>::length(event.name));
+      writer.key("cat");
+      writer.value("whatsupdoc", 10);
+      writer.key("ph");
+      writer.value("X", 1);
+      // microseconds
+      writer.key("ts");
+      writer.number(static_cast<int64_t>(event.start / 1000));
+      writer.key("dur");
+      writer.real(event.duration * 1e-3);
+      writer.key("pid");
+      writer.number(1);
+      writer.key("tid");
+      writer.number(buffer->tid);
+      if(!event.detail.empty()) {
+        writer.key("args");
+        writer.beginObject();
+        writer.key("detail");
+        writer.value(event.detail);
+        writer.endObject();
+      }
+      writer.endObject();
+    }
+  }
+  writer.endArray();
+  writer.endObject();
+  return writer.close();
+}
+
+} /* WhatsUpDoc */
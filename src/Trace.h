@@ -0,0 +1,53 @@
+#ifndef WHATSUPDOC_TRACE_H_
+#define WHATSUPDOC_TRACE_H_
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+namespace WhatsUpDoc {
+
+extern std::atomic<bool> tracingEnabled;
+
+// starts recording spans of all threads
+void enableTracing();
+inline bool isTracing() { return tracingEnabled.load(std::memory_order_relaxed); }
+// writes the recorded spans in the chrome trace event format (chrome://tracing, Perfetto)
+bool writeTrace(const std::string& path);
+
+/**
+ * Records the lifetime of the object as a span of the calling thread.
+ * Without tracing, a span only checks the flag.
+ */
+class TraceSpan {
+public:
+  explicit TraceSpan(const char* name) : name(name), active(isTracing()) {
+    if(active)
+      start = now();
+  }
+  ~TraceSpan() {
+    if(active)
+      finish();
+  }
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+  
+  bool isActive() const { return active; }
+  // shown as argument of the span, ignored without tracing
+  void setDetail(const std::string& text) {
+    if(active)
+      detail = text;
+  }
+private:
+  static uint64_t now();
+  void finish();
+  
+  const char* name;
+  bool active;
+  uint64_t start = 0;
+  std::string detail;
+};
+
+} /* WhatsUpDoc */
+
+#endif /* end of include guard: WHATSUPDOC_TRACE_H_ */
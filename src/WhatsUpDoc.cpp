@@ -1,34 +1,120 @@
 #include "Parser.h"
 #include "Helper.h"
+#include "FileFilter.h"
+#include "FileDiscovery.h"
+#include "Bundle.h"
+#include "FileWatcher.h"
+#include "Statistics.h"
+#include "Trace.h"
 #include <EScript/Utils/IO/IO.h>
 #include <EScript/Utils/StringUtils.h>
 #include <iostream>
 #include <cmath>
-#include <regex>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_set>
 
 using namespace WhatsUpDoc;
 using namespace EScript;
 
+// prints the document of a compound (by id or full name) from a bundle
+static int lookup(const std::string& file, const std::string& name) {
+  BundleReader bundle;
+  if(!bundle.open(file)) {
+    std::cerr << "invalid bundle '" << file << "'." << std::endl;
+    return 1;
+  }
+  auto record = bundle.findById(name);
+  if(record.isNull())
+    record = bundle.findByFullname(name);
+  if(record.isNull()) {
+    std::cerr << "'" << name << "' not found." << std::endl;
+    return 1;
+  }
+  std::cout.write(record.data, record.length);
+  return 0;
+}
+
 int main(int argc, const char * argv[]) {
-  if(argc != 2) {
-    std::cout << "usage: WhatsUpDoc <DocFile>" << std::endl;
+  std::string configFile;
+  int threads = -1;
+  int filter = -1;
+  int bundle = -1;
+  std::string statsFile;
+  size_t statsTop = 10;
+  std::string traceFile;
+  bool watch = false;
+  std::string compileFile;
+  std::string artifactFile;
+  bool link = false;
+  std::vector<std::string> linkFiles;
+  for(int i=1; i<argc; ++i) {
+    std::string arg = argv[i];
+    if(arg == "--lookup" && i+2 < argc) {
+      return lookup(argv[i+1], argv[i+2]);
+    } else if(arg == "-j" && i+1 < argc) {
+      threads = std::max(0, std::atoi(argv[++i]));
+    } else if(arg.compare(0, 2, "-j") == 0 && arg.size() > 2) {
+      threads = std::max(0, std::atoi(arg.c_str()+2));
+    } else if(arg == "--no-filter") {
+      filter = 0;
+    } else if(arg == "--bundle") {
+      bundle = 1;
+    } else if(arg == "--stats" && i+1 < argc) {
+      statsFile = argv[++i];
+    } else if(arg == "--stats-top" && i+1 < argc) {
+      statsTop = std::max(0, std::atoi(argv[++i]));
+    } else if(arg == "--trace" && i+1 < argc) {
+      traceFile = argv[++i];
+    } else if(arg == "--watch") {
+      watch = true;
+    } else if(arg == "--compile" && i+1 < argc) {
+      compileFile = argv[++i];
+    } else if(arg == "-o" && i+1 < argc) {
+      artifactFile = argv[++i];
+    } else if(arg == "--link") {
+      link = true;
+    } else if(link && arg.size() > 4 && arg.compare(arg.size()-4, 4, ".wud") == 0) {
+      linkFiles.emplace_back(arg);
+    } else if(configFile.empty() && arg[0] != '-') {
+      configFile = arg;
+    } else {
+      configFile.clear();
+      break;
+    }
+  }
+  if(configFile.empty() || (watch && (!compileFile.empty() || link)) || (!compileFile.empty() && link)) {
+    std::cout << "usage: WhatsUpDoc [-j <threads>] [--no-filter] [--bundle] [--stats <file> [--stats-top <n>]] [--trace <file>] [--watch] <DocFile>" << std::endl;
+    std::cout << "       WhatsUpDoc --compile <source> [-o <file.wud>] <DocFile>" << std::endl;
+    std::cout << "       WhatsUpDoc --link <file.wud>... [--bundle] <DocFile>" << std::endl;
+    std::cout << "       WhatsUpDoc --lookup <bundle> <id|fullname>" << std::endl;
     return 0;
   }
+  if(!compileFile.empty() && artifactFile.empty())
+    artifactFile = compileFile + ".wud";
   
   // parse config file
-  if(IO::getEntryType(argv[1]) != IO::TYPE_FILE) {
-    std::cerr << "config file '" <<  argv[1]<< "' not found." << std::endl;
+  if(IO::getEntryType(configFile) != IO::TYPE_FILE) {
+    std::cerr << "config file '" <<  configFile << "' not found." << std::endl;
     return 1;
   }
   std::string projectFolder = ".";
   std::string outputFolder = "json";
+  std::string cacheFolder;
+  std::string compileCommands;
   std::vector<std::string> includes;
   std::vector<std::string> input;
   std::vector<std::string> defines;
   std::vector<std::string> flags;
   std::vector<std::string> patterns;
+  std::vector<std::string> pchHeaders;
+  std::vector<std::string> excludes;
+  std::vector<std::string> excludePatterns;
+  int configThreads = 1;
+  bool configFilter = true;
+  bool configBundle = false;
   
-  auto configLines = StringUtils::split(IO::loadFile(argv[1]).str(), "\n");
+  auto configLines = StringUtils::split(IO::loadFile(configFile).str(), "\n");
   int lineNr = 0;
   for(auto& line : configLines) {
     lineNr++;
@@ -48,6 +134,10 @@ int main(int argc, const char * argv[]) {
       projectFolder = IO::condensePath(value);
     } else if(key == "OUTPUT_DIRECTORY") {
       outputFolder = value;
+    } else if(key == "CACHE_DIR") {
+      cacheFolder = value;
+    } else if(key == "COMPILE_COMMANDS") {
+      compileCommands = value;
     } else if(key == "INPUT") {
       for(auto& v : StringUtils::split(value, " ")) {
         v = StringUtils::trim(v);
@@ -62,6 +152,18 @@ int main(int argc, const char * argv[]) {
         if(!v.empty())
           includes.emplace_back(v);
       }
+    } else if(key == "EXCLUDE") {
+      for(auto& v : StringUtils::split(value, " ")) {
+        v = StringUtils::trim(v);
+        if(!v.empty())
+          excludes.emplace_back(v);
+      }
+    } else if(key == "EXCLUDE_PATTERNS") {
+      for(auto& v : StringUtils::split(value, " ")) {
+        v = StringUtils::trim(v);
+        if(!v.empty())
+          excludePatterns.emplace_back(v);
+      }
     } else if(key == "PREDEFINED") {
       for(auto& v : StringUtils::split(value, " ")) {
         v = StringUtils::trim(v);
@@ -80,8 +182,26 @@ int main(int argc, const char * argv[]) {
         if(!v.empty())
           patterns.emplace_back(v);
       }
+    } else if(key == "PRECOMPILED_HEADERS") {
+      for(auto& v : StringUtils::split(value, " ")) {
+        v = StringUtils::trim(v);
+        if(!v.empty())
+          pchHeaders.emplace_back(v);
+      }
+    } else if(key == "THREADS") {
+      configThreads = std::max(0, std::atoi(value.c_str()));
+    } else if(key == "FILTER_FILES") {
+      configFilter = value != "NO" && value != "0";
+    } else if(key == "OUTPUT_FORMAT") {
+      configBundle = value == "BUNDLE";
     }
   }
+  if(threads < 0)
+    threads = configThreads;
+  if(filter < 0)
+    filter = configFilter ? 1 : 0;
+  if(bundle < 0)
+    bundle = configBundle ? 1 : 0;
   
   if(IO::getEntryType(projectFolder) != IO::TYPE_DIRECTORY) {
     std::cerr << "invalid project folder '" << projectFolder << "'." << std::endl;
@@ -89,12 +209,30 @@ int main(int argc, const char * argv[]) {
   }
   
   outputFolder = IO::condensePath(projectFolder.empty() ? outputFolder : (projectFolder + "/" + outputFolder));
-  if(IO::getEntryType(outputFolder) != IO::TYPE_DIRECTORY) {
+  if(compileFile.empty() && IO::getEntryType(outputFolder) != IO::TYPE_DIRECTORY) {
     std::cerr << "invalid output folder '" << outputFolder << "'." << std::endl;
     return 1;
   }
     
+  if(!traceFile.empty())
+    enableTracing();
+  
   Parser parser;  
+  if(!statsFile.empty())
+    parser.enableStatistics();
+  if(!cacheFolder.empty()) {
+    cacheFolder = IO::condensePath(projectFolder.empty() ? cacheFolder : (projectFolder + "/" + cacheFolder));
+    if(IO::getEntryType(cacheFolder) != IO::TYPE_DIRECTORY) {
+      std::cerr << "invalid cache folder '" << cacheFolder << "'." << std::endl;
+      return 1;
+    }
+    // the watch mode keeps all translation units in memory instead
+    if(!watch)
+      parser.setCacheDir(cacheFolder);
+  }
+  if(watch)
+    parser.enableIncremental();
+  
   parser.addInclude(projectFolder);
   for(auto& inc : includes) {
     inc = IO::condensePath(projectFolder.empty() ? inc : (projectFolder + "/" + inc));
@@ -110,49 +248,174 @@ int main(int argc, const char * argv[]) {
   for(auto& flag : flags)
     parser.addFlag(flag);
   
-  std::vector<std::string> cppfiles;
+  if(!pchHeaders.empty()) {
+    std::string pchFile = (cacheFolder.empty() ? projectFolder : cacheFolder) + "/whatsupdoc.pch";
+    if(!parser.usePrecompiledHeader(pchHeaders, pchFile))
+      std::cerr << "could not create precompiled header, parsing without." << std::endl;
+  }
+  
   size_t maxLength = 1;
   
+  // per-file compiler arguments (and optionally the input files) from a compile_commands.json
+  std::vector<std::string> databaseFiles;
+  bool inputFromDatabase = false;
+  if(!compileCommands.empty()) {
+    compileCommands = IO::condensePath(projectFolder.empty() ? compileCommands : (projectFolder + "/" + compileCommands));
+    if(!parser.loadCompilationDatabase(compileCommands, &databaseFiles)) {
+      std::cerr << "could not load compilation database from '" << compileCommands << "'." << std::endl;
+      return 1;
+    }
+    inputFromDatabase = input.empty();
+  }
+  
   if(patterns.empty())
     patterns.emplace_back("*.cpp");
   
-  if(input.empty()) input.emplace_back("");
+  for(auto& path : excludes)
+    path = getRealPath(IO::condensePath(projectFolder.empty() ? path : (projectFolder + "/" + path)));
+  
+  std::vector<std::string> scope = {projectFolder};
+  std::vector<std::string> inputFolders;
+  if(input.empty() && !inputFromDatabase) input.emplace_back("");
   for(auto& path : input) {
     path = IO::condensePath(projectFolder.empty() ? path : (projectFolder + "/" + path));
     if(IO::getEntryType(path) != IO::TYPE_DIRECTORY) {
       std::cerr << "invalid input dir '" << path << "'." << std::endl;
       continue;
     }
-    
-    std::deque<std::string> queue = {IO::condensePath(path)};
-    while(!queue.empty()) {
-      auto dir = queue.front();
-      queue.pop_front();
-      auto files = IO::getFilesInDir(dir, 1);
-      for(auto& f : files) {
-        bool valid = false;
-        for(auto& p : patterns)
-          valid |= matchWildcard(f, p);
-        if(valid) {
-          cppfiles.emplace_back(f);
-          maxLength = std::max(maxLength, f.size());
-        }
+    scope.emplace_back(path);
+    inputFolders.emplace_back(path);
+  }
+  
+  parser.setScope(scope, excludes);
+  
+  // extraction results of a single file for a later link step
+  if(!compileFile.empty()) {
+    bool success = parser.compileFile(compileFile, artifactFile);
+    if(!traceFile.empty() && !writeTrace(traceFile))
+      std::cerr << "could not write trace to '" << traceFile << "'." << std::endl;
+    return success ? 0 : 1;
+  }
+  
+  // input files (without filtering)
+  auto discover = [&]() {
+    std::vector<std::string> files;
+    if(inputFromDatabase) {
+      auto projectPath = getRealPath(projectFolder);
+      std::vector<WildcardPattern> include(patterns.begin(), patterns.end());
+      std::vector<WildcardPattern> exclude(excludePatterns.begin(), excludePatterns.end());
+      for(auto& f : databaseFiles) {
+        bool valid = hasPathPrefix(f, projectPath);
+        valid = valid && std::any_of(include.begin(), include.end(), [&](const WildcardPattern& p) { return p.match(f); });
+        valid = valid && std::none_of(exclude.begin(), exclude.end(), [&](const WildcardPattern& p) { return p.match(f); });
+        valid = valid && std::none_of(excludes.begin(), excludes.end(), [&](const std::string& e) { return hasPathPrefix(f, e); });
+        if(valid)
+          files.emplace_back(f);
       }
-      auto dirs = IO::getFilesInDir(dir, 2);
-      for(auto& d : dirs)
-        queue.emplace_back(d);
+    } else {
+      DiscoveryOptions discovery;
+      discovery.patterns = patterns;
+      discovery.excludePatterns = excludePatterns;
+      discovery.excludePaths = excludes;
+      discovery.threads = static_cast<unsigned int>(threads);
+      files = findFiles(inputFolders, discovery);
+    }
+    return files;
+  };
+  // removes the files that can not contain any bindings, returns the removed ones
+  auto skipFiles = [&](std::vector<std::string>& files) {
+    std::vector<std::string> skipped;
+    if(filter) {
+      auto it = std::stable_partition(files.begin(), files.end(), [](const std::string& f) { return mayContainBindings(f); });
+      skipped.assign(it, files.end());
+      files.erase(it, files.end());
     }
+    return skipped;
+  };
+  
+  std::vector<std::string> cppfiles;
+  if(link) {
+    if(!parser.linkFiles(linkFiles))
+      return 1;
+    std::cout << "Linked " << linkFiles.size() << " files" << std::endl;
+  } else {
+    Stopwatch discoveryWatch;
+    cppfiles = discover();
+    if(parser.getStatistics())
+      parser.getStatistics()->addPhase(Statistics::DISCOVERY, discoveryWatch);
+    std::cout << "Found " << cppfiles.size() << " files in " << discoveryWatch.getWallTime() << "s" << std::endl;
+  
+    // skip files that can not contain any bindings
+    auto skipped = skipFiles(cppfiles);
+    if(!skipped.empty()) {
+      std::sort(skipped.begin(), skipped.end());
+      std::cout << "Skipped " << skipped.size() << " of " << (cppfiles.size() + skipped.size()) << " files without EScript bindings:" << std::endl;
+      for(auto& f : skipped)
+        std::cout << "  " << f << std::endl;
+    }
+    for(auto& f : cppfiles)
+      maxLength = std::max(maxLength, f.size());
+  
+    parser.parseFiles(cppfiles, threads, [&](const std::string& f, size_t progress) {
+      int percent = static_cast<float>(progress)/cppfiles.size()*100;
+      std::cout << "\r[" << percent << "%] Parsing " << f << std::string(maxLength-f.size(), ' ') << std::flush;
+    });
+    std::cout << std::endl << "[100%] Finished parsing";
+    if(!cacheFolder.empty())
+      std::cout << " (" << parser.getCacheHits() << " of " << cppfiles.size() << " files loaded from cache)";
+    std::cout << std::endl;
   }
   
-  int progress = 0;
-  for(auto& f : cppfiles) {
-    int percent = static_cast<float>(progress)/cppfiles.size()*100;
-    std::cout << "\r[" << percent << "%] Parsing " << f << std::string(maxLength-f.size(), ' ') << std::flush;
-    parser.parseFile(f);
-    ++progress;
+  if(bundle)
+    parser.writeBundle(outputFolder + "/whatsupdoc.bundle");
+  else
+    parser.writeJSON(outputFolder);
+  
+  if(!traceFile.empty() && !writeTrace(traceFile))
+    std::cerr << "could not write trace to '" << traceFile << "'." << std::endl;
+  if(parser.getStatistics() && !parser.getStatistics()->write(statsFile, statsTop)) {
+    std::cerr << "could not write statistics to '" << statsFile << "'." << std::endl;
+    return 1;
   }
-  std::cout << std::endl << "[100%] Finished parsing" << std::endl;
   
-  parser.writeJSON(outputFolder);
+  // reparse the translation units affected by changed files & rewrite the changed documents,
+  // files created in the input folders are discovered & parsed as well
+  if(watch) {
+    std::unordered_set<std::string> parsedFiles(cppfiles.begin(), cppfiles.end());
+    FileWatcher watcher;
+    watcher.setFiles(parser.getDependencies(), inputFolders);
+    while(true) {
+      std::cout << "Watching for changes..." << std::endl;
+      auto changed = watcher.wait();
+      Stopwatch updateWatch;
+      size_t count = parser.update(changed);
+      auto dependencies = parser.getDependencies();
+      bool created = std::any_of(changed.begin(), changed.end(), [&](const std::string& f) {
+        return !std::binary_search(dependencies.begin(), dependencies.end(), f);
+      });
+      if(created) {
+        auto files = discover();
+        skipFiles(files);
+        files.erase(std::remove_if(files.begin(), files.end(), [&](const std::string& f) { return parsedFiles.count(f) > 0; }), files.end());
+        if(!files.empty()) {
+          parser.parseFiles(files, threads);
+          parsedFiles.insert(files.begin(), files.end());
+          count += files.size();
+        }
+      }
+      if(count == 0) {
+        // new folders have to be watched as well
+        if(created)
+          watcher.setFiles(dependencies, inputFolders);
+        continue;
+      }
+      if(bundle)
+        parser.writeBundle(outputFolder + "/whatsupdoc.bundle");
+      else
+        parser.writeJSON(outputFolder);
+      watcher.setFiles(parser.getDependencies(), inputFolders);
+      std::cout << "Reparsed " << count << " files in " << updateWatch.getWallTime() << "s" << std::endl;
+    }
+  }
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,247 @@
+/*
+ * Compares the comment scanner (src/CommentParser.cpp) with the former regex based
+ * comment parser, which is kept below as reference. Both have to produce the same
+ * token stream for hand-written samples & a fixed set of generated comments.
+ *
+ * Usage: CommentParserTest [generated comments=2000]
+ */
+#include "CommentParser.h"
+
+#include <EScript/Utils/StringUtils.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <regex>
+#include <random>
+#include <cstdlib>
+
+using namespace WhatsUpDoc;
+
+// -------------------------------------------------
+// reference: regex based parser as used before the scanner
+
+namespace Reference {
+using namespace EScript::StringUtils;
+
+struct Token {
+  CommentToken::Tag tag;
+  uint32_t line;
+  std::string text;
+  std::string name;
+};
+
+static std::string escapeMarkdown(const std::string& str) {
+  return replaceMultiple(str, {
+    {"|","\\|"},
+    {"*","\\*"},
+  });
+}
+
+static std::deque<Token> parseComment(const std::string& comment, const Location& location) {
+  std::deque<Token> result;
+
+  std::stringstream regex;
+  regex << R"((?:(?:/\*(?:!|\*+))|(?://(?:!|/+))|(?:\s*\*+/?)|(?:\s{)" << location.col << R"(}))\s?(.*))";
+  std::regex lineRegex = std::regex(regex.str());
+
+  std::regex defGrpRegex = std::regex(R"((?:@|\\)defgroup\s+(\w+)\s+(.*))");
+  std::regex grpRegex = std::regex(R"((?:@|\\)(addtogroup|ingroup)\s+(\w+))");
+  std::regex mgrpRegex = std::regex(R"((?:@|\\)name\s+(.*))");
+  std::regex deprRegex = std::regex(R"((.*)(?:@|\\)deprecated\s*(.*))");
+  std::regex blockRegex = std::regex(R"(@(\{|\}))");
+  std::regex codeStartRegex = std::regex(R"((?:@|\\)code\s*(.*))");
+  std::regex codeLangRegex = std::regex(R"((?:\{?\.?)(\w+)((?:\}?)))");
+  std::regex codeEndRegex = std::regex(R"((?:@|\\)endcode\s*)");
+
+  auto lines = split(comment, "\n");
+  uint32_t i=location.line;
+  bool codeLine = false;
+  for(auto& line : lines) {
+    line = std::regex_replace(line, lineRegex, "$1");
+    std::smatch match;
+    if(std::regex_match(line, match, defGrpRegex)) {
+      result.push_back({CommentToken::DEF_GROUP, i, match[1], match[2]});
+    } else if(std::regex_match(line, match, grpRegex)) {
+      result.push_back({CommentToken::IN_GROUP, i, match[2], ""});
+    } else if(std::regex_match(line, match, mgrpRegex)) {
+      result.push_back({CommentToken::MEMBER_GROUP, i, match[1], ""});
+    } else if(std::regex_match(line, match, blockRegex)) {
+      if(match[1] == "{")
+        result.push_back({CommentToken::BLOCK_START, i, "", ""});
+      else if(match[1] == "}")
+        result.push_back({CommentToken::BLOCK_END, i, "", ""});
+    } else if(std::regex_match(line, match, deprRegex)) {
+      if(!trim(match[1]).empty())
+        result.push_back({CommentToken::TEXT_LINE, i, escapeMarkdown(match[1]), ""});
+      result.push_back({CommentToken::DEPRECATED, i, match[2], ""});
+    } else if(std::regex_match(line, match, codeStartRegex)) {
+      std::string lang = std::regex_replace(match[1].str(), codeLangRegex, "$1");
+      result.push_back({CommentToken::CODE_BLOCK_START, i, lang, ""});
+      codeLine = true;
+    } else if(std::regex_match(line, match, codeEndRegex)) {
+      result.push_back({CommentToken::CODE_BLOCK_END, i, "", ""});
+      codeLine = false;
+    } else if(codeLine) {
+      result.push_back({CommentToken::CODE_LINE, i, line, ""});
+    } else {
+      result.push_back({CommentToken::TEXT_LINE, i, escapeMarkdown(line), ""});
+    }
+    ++i;
+  }
+  // remove first & last empty lines
+  if(!result.empty() && result.front().tag == CommentToken::TEXT_LINE && trim(result.front().text).empty())
+    result.pop_front();
+  if(!result.empty() && result.back().tag == CommentToken::TEXT_LINE && trim(result.back().text).empty())
+    result.pop_back();
+  result.push_back({CommentToken::COMMENT_END, i, "", ""});
+  return result;
+}
+
+} /* Reference */
+
+// -------------------------------------------------
+
+static std::string dump(const std::deque<Reference::Token>& tokens) {
+  std::string result;
+  for(auto& token : tokens) {
+    result += std::to_string(token.tag) + ":" + std::to_string(token.line) + ":" + token.text;
+    if(token.tag == CommentToken::DEF_GROUP)
+      result += "|" + token.name;
+    result += "\n";
+  }
+  return result;
+}
+
+static std::string dump(CommentBuffer& buffer) {
+  std::string result;
+  for(; !buffer.empty(); buffer.popFront()) {
+    auto& token = buffer.front();
+    result += std::to_string(token.tag) + ":" + std::to_string(token.line) + ":";
+    switch(token.tag) {
+      case CommentToken::TEXT_LINE:
+        buffer.appendEscaped(token, result);
+        break;
+      case CommentToken::DEF_GROUP:
+        result += buffer.getText(token) + "|" + buffer.getName(token);
+        break;
+      case CommentToken::IN_GROUP:
+      case CommentToken::MEMBER_GROUP:
+      case CommentToken::DEPRECATED:
+      case CommentToken::CODE_BLOCK_START:
+      case CommentToken::CODE_LINE:
+        result += buffer.getText(token);
+        break;
+      default:
+        break;
+    }
+    result += "\n";
+  }
+  return result;
+}
+
+// returns false & prints both token streams if they differ
+static bool compare(const std::string& comment, unsigned int col) {
+  Location location{"test.cpp", 7, col};
+  CommentBuffer buffer;
+  parseComment(comment.data(), comment.size(), location, buffer);
+  auto expected = dump(Reference::parseComment(comment, location));
+  auto actual = dump(buffer);
+  if(expected == actual)
+    return true;
+  std::cout << "mismatch (column " << col << ") for:" << std::endl << comment << std::endl;
+  std::cout << "expected:" << std::endl << expected << "actual:" << std::endl << actual << std::endl;
+  return false;
+}
+
+// -------------------------------------------------
+
+static const std::vector<std::string> SAMPLES = {
+  // descriptions & markdown escaping
+  "/** Returns the value. */",
+  "/**\n * Returns the value.\n *\n * | a * b |\n */",
+  "/*!\n   Indented text without stars.\n     deeper\n */",
+  "/// single line\n/// second line",
+  "//! bang comment",
+  "//// many slashes\n/*** many stars ***/",
+  "/**\n * text * inside * stars */",
+  // groups & member groups
+  "/** @defgroup math Math functions */",
+  "/**\n * \\defgroup io Input & output\n * Reads and writes files.\n */",
+  "/** @ingroup math */",
+  "/** \\addtogroup io */",
+  "/** @ingroup two words */",
+  "/** @name Getters */",
+  "/** \\name  */",
+  "/**\n * @name Setters\n * @{\n */",
+  "/** @} */",
+  "/**\n * @{\n * @{\n * nested\n * @}\n * @}\n */",
+  "/** @{ text */",
+  // parameters & other unknown commands stay text
+  "/**\n * Sets the value.\n * @param value the new value\n * \\param[in] other\n * @return the old value\n */",
+  // deprecation
+  "/** @deprecated */",
+  "/** @deprecated use other() */",
+  "/** Old function. @deprecated use other() */",
+  "/** @deprecated first @deprecated second */",
+  "/**\n * \\deprecated\n *   since 1.2\n */",
+  // code blocks
+  "/**\n * @code\n * x = 1;\n * @endcode\n */",
+  "/**\n * @code{.cpp}\n * int x;\n * \\endcode\n */",
+  "/**\n * @code{.escript}\n * var x = new Foo();\n * @endcode  \n */",
+  "/**\n * \\code {. weird lang}\n * a | b * c\n */",
+  "/** @code */",
+  // unterminated & malformed blocks
+  "/**\n * text without end",
+  "/**",
+  "/** */",
+  "///",
+  "/**\n *\n *\n */",
+  "/**\n * @defgroup\n * @ingroup\n * @name\n */",
+  // CRLF line endings
+  "/**\r\n * Returns the value.\r\n * @ingroup math\r\n * @name Getters\r\n */",
+  "/**\r\n * @deprecated use other()\r\n * @code{.cpp}\r\n * x = 1;\r\n * @endcode\r\n */\r\n",
+  "/// line\r\n/// @{\r\n/// @}\r\n",
+  // tabs & other whitespace
+  "/**\n\t* tab indented\n\t*/",
+  "/**\v * vertical tab\f */",
+};
+
+// fragments of the generated comments
+static const char* FRAGMENTS[] = {
+  "/**", "/*!", "//!", "///", "////", "/*", "//", "*", "**", "*/", " ", "  ", "\t", "\r", "\n", "\n", "\n", "\r\n",
+  "@defgroup", "\\defgroup", "@ingroup", "\\addtogroup", "@name", "@param", "@{", "@}", "@deprecated", "\\deprecated",
+  "@code", "\\endcode", "@endcode", "{.cpp}", "{.", "}", "{", "foo", "Bar_1", "|", "text", "x", "@", "\\",
+  "deprecated", "code", "grp", ". ", "\v",
+};
+
+int main(int argc, char* argv[]) {
+  int count = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const unsigned int columns[] = {0, 1, 2, 3, 5};
+  size_t failed = 0;
+  size_t total = 0;
+  for(auto& comment : SAMPLES) {
+    for(auto col : columns) {
+      failed += compare(comment, col) ? 0 : 1;
+      ++total;
+    }
+  }
+
+  // fixed seed, the generated comments are the same for every run
+  std::mt19937 random(42);
+  const size_t fragmentCount = sizeof(FRAGMENTS) / sizeof(FRAGMENTS[0]);
+  for(int i=0; i<count && failed < 10; ++i) {
+    std::string comment;
+    size_t length = random() % 30;
+    for(size_t k=0; k<length; ++k)
+      comment += FRAGMENTS[random() % fragmentCount];
+    for(auto col : columns) {
+      failed += compare(comment, col) ? 0 : 1;
+      ++total;
+    }
+  }
+
+  std::cout << (total - failed) << " of " << total << " comments parsed identically" << std::endl;
+  return failed == 0 ? 0 : 1;
+}